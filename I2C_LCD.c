@@ -11,17 +11,115 @@
 #include <I2C_LCD.h>
 #include <ch32v00x_i2c.h>
 #include <ch32v00x_rcc.h>
-#include <stdio.h>
+#include <ch32v00x_tim.h>
+#include <ch32v00x_misc.h>
 #include <string.h>
 
-dataTypeDef dataStructure = {0};
-displayTypeDef displayStructure = {0};
-entryTypeDef entryStructure = {0};
+stateTypeDef stateStructure = {0};
+#if LCD_USE_STATS
+statsTypeDef statsStructure = {0};
+#endif
 
 uint8_t colmax;
 uint8_t rowmax;
 uint8_t Txaddr;
 
+static uint8_t datapack;
+static uint8_t e_pins;
+static uint8_t e_sel = E1_bit;
+static uint16_t bus_us;
+static uint16_t exec_owed[LCD_CONTROLLERS];
+
+#if LCD_CONTROLLERS > 1
+static uint8_t lcd_dual;
+static uint8_t e_all = E1_bit;
+#else
+#define lcd_dual                    0
+#define e_all                       E1_bit
+#endif
+
+static uint8_t ac_addr[LCD_CONTROLLERS];
+static uint8_t ac_valid[LCD_CONTROLLERS];
+static uint8_t cur_row;
+static uint8_t cur_col;
+static uint8_t cur_ctrl;
+
+#if LCD_USE_SHADOW
+static uint8_t ddram_shadow[LCD_CONTROLLERS * 80];
+#endif
+
+#if LCD_USE_BACKLIGHT
+static volatile uint8_t bus_busy;
+static volatile uint8_t bus_last;
+static volatile uint8_t bclight_pending;
+#endif
+
+#if LCD_USE_PWM
+static volatile uint8_t pwm_running;
+static volatile uint8_t pwm_led;
+static volatile uint8_t pwm_phase;
+static volatile uint8_t pwm_level = BCLIGHT_PWM_LEVELS;
+static volatile uint8_t pwm_target = BCLIGHT_PWM_LEVELS;
+static volatile uint16_t fade_step;
+static volatile uint16_t fade_count;
+#endif
+
+#if LCD_LOWPOWER
+static volatile uint8_t lcd_tick_done;
+static uint8_t bus_slept;
+#endif
+
+/* The PWM output is kept out of stateStructure so the timer interrupt never
+ * does a read-modify-write on the byte the main line is updating. */
+#if LCD_USE_PWM
+#define LED_STATE                   (pwm_running ? pwm_led : stateStructure.Led)
+#elif LCD_USE_BACKLIGHT
+#define LED_STATE                   (stateStructure.Led)
+#else
+#define LED_STATE                   1
+#endif
+
+#if LCD_USE_SHIFT
+#define ENTRY_BYTE                  (LCD_ENTRY | stateStructure.disp_shift | (stateStructure.cur_dir << 1))
+#define ENTRY_RIGHT                 (stateStructure.cur_dir)
+#else
+#define ENTRY_BYTE                  (LCD_ENTRY | (cur_right << 1))
+#define ENTRY_RIGHT                 1
+#endif
+
+#if LCD_USE_CURSOR
+#define CURSOR_BITS                 (stateStructure.blink_state | (stateStructure.cur_state << 1))
+#else
+#define CURSOR_BITS                 0
+#endif
+
+#if LCD_USE_STATS
+#define STATS_ADD(field, n)         (statsStructure.field += (n))
+#else
+#define STATS_ADD(field, n)         ((void)0)
+#endif
+
+static void expander_Write(const uint8_t *packets, uint8_t len);
+static void i2c_Send(const uint8_t *packets, uint8_t len);
+#if LCD_USE_BACKLIGHT
+static void bclight_Update(void);
+#endif
+static uint8_t lcd_Geometry(uint8_t row_limit, uint8_t col_limit);
+static void lcd_Reset(void);
+static uint8_t row_Addr(uint8_t row);
+static void lcd_Goto(uint8_t row, uint8_t col);
+static void lcd_Data(uint8_t packet);
+static void lcd_Exec(uint16_t us);
+static void lcd_Wait(uint8_t sel);
+static void ac_Home(void);
+static void ac_Step(uint8_t ctrl, uint8_t up);
+#if LCD_USE_READ
+static void read_Block(uint8_t rs, uint8_t *buf, uint8_t len);
+#endif
+static void display_Control(void);
+static void lcd_Delay(uint32_t us);
+static void i2c_Wait(uint32_t event);
+
 /*********************************************************************
  * @fn      i2c_Begin
  *
@@ -60,6 +158,12 @@ void i2c_Begin(u32 bound, uint8_t address)
     I2C_Init( I2C1, &I2C_InitSturcture );
 
     I2C_Cmd( I2C1, ENABLE );
+
+#if LCD_LOWPOWER
+    NVIC_EnableIRQ( I2C1_EV_IRQn );
+#endif
+
+    bus_us = 20 * 1000000 / bound;
 }
 
 /*********************************************************************
@@ -73,10 +177,15 @@ void i2c_Begin(u32 bound, uint8_t address)
  */
 void clear(void)
 {
-    dataStructure.rs = Instruct_in;
+    stateStructure.rs = Instruct_in;
+
+    lcd_Write(LCD_CLEAR , RESET);
+    lcd_Exec(2000);
 
-    lcd_Write(0x01 , RESET);
-    Delay_Ms(2);
+#if LCD_USE_SHADOW
+    memset(ddram_shadow, ' ', sizeof(ddram_shadow));
+#endif
+    ac_Home();
 }
 
 /*********************************************************************
@@ -90,10 +199,12 @@ void clear(void)
  */
 void home(void)
 {
-    dataStructure.rs = Instruct_in;
+    stateStructure.rs = Instruct_in;
 
-    lcd_Write(0x02 , RESET);
-    Delay_Ms(2);
+    lcd_Write(LCD_HOME , RESET);
+    lcd_Exec(2000);
+
+    ac_Home();
 }
 
 /*********************************************************************
@@ -107,16 +218,8 @@ void home(void)
  */
 void display_On(void)
 {
-    dataStructure.rs = Instruct_in;
-    displayStructure.disp_state = SET;
-
-    uint8_t buf = 0x08;
-    buf |= displayStructure.blink_state;
-    buf |= displayStructure.cur_state << 1;
-    buf |= displayStructure.disp_state << 2;
-
-    lcd_Write(buf , RESET);
-    Delay_Us(37);
+    stateStructure.disp_state = SET;
+    display_Control();
 }
 
 /*********************************************************************
@@ -130,18 +233,11 @@ void display_On(void)
  */
 void display_Off(void)
 {
-    dataStructure.rs = Instruct_in;
-    displayStructure.disp_state = RESET;
-
-    uint8_t buf = 0x08;
-    buf |= displayStructure.blink_state;
-    buf |= displayStructure.cur_state << 1;
-    buf &= ~(1 << 2);
-
-    lcd_Write(buf , RESET);
-    Delay_Us(37);
+    stateStructure.disp_state = RESET;
+    display_Control();
 }
 
+#if LCD_USE_CURSOR
 /*********************************************************************
  * @fn      cursor_On
  *
@@ -153,16 +249,8 @@ void display_Off(void)
  */
 void cursor_On(void)
 {
-    dataStructure.rs = Instruct_in;
-    displayStructure.cur_state = SET;
-
-    uint8_t buf = 0x08;
-    buf |= displayStructure.blink_state;
-    buf |= displayStructure.cur_state << 1;
-    buf |= displayStructure.disp_state << 2;
-
-    lcd_Write(buf , RESET);
-    Delay_Us(37);
+    stateStructure.cur_state = SET;
+    display_Control();
 }
 
 /*********************************************************************
@@ -176,16 +264,8 @@ void cursor_On(void)
  */
 void cursor_Off(void)
 {
-    dataStructure.rs = Instruct_in;
-    displayStructure.cur_state = RESET;
-
-    uint8_t buf = 0x08;
-    buf |= displayStructure.blink_state;
-    buf &= ~(1 << 1);
-    buf |= displayStructure.disp_state << 2;
-
-    lcd_Write(buf , RESET);
-    Delay_Us(37);
+    stateStructure.cur_state = RESET;
+    display_Control();
 }
 
 /*********************************************************************
@@ -199,16 +279,8 @@ void cursor_Off(void)
  */
 void blink_On(void)
 {
-    dataStructure.rs = Instruct_in;
-    displayStructure.blink_state = SET;
-
-    uint8_t buf = 0x08;
-    buf |= displayStructure.blink_state;
-    buf |= displayStructure.cur_state << 1;
-    buf |= displayStructure.disp_state << 2;
-
-    lcd_Write(buf , RESET);
-    Delay_Us(37);
+    stateStructure.blink_state = SET;
+    display_Control();
 }
 
 /*********************************************************************
@@ -222,18 +294,13 @@ void blink_On(void)
  */
 void blink_Off(void)
 {
-    dataStructure.rs = Instruct_in;
-    displayStructure.blink_state = RESET;
-
-    uint8_t buf = 0x08;
-    buf &= ~(1);
-    buf |= displayStructure.cur_state << 1;
-    buf |= displayStructure.disp_state << 2;
-
-    lcd_Write(buf , RESET);
-    Delay_Us(37);
+    stateStructure.blink_state = RESET;
+    display_Control();
 }
 
+#endif
+
+#if LCD_USE_SHIFT
 /*********************************************************************
  * @fn      entry_Right
  *
@@ -245,15 +312,11 @@ void blink_Off(void)
  */
 void entry_Right(void)
 {
-    dataStructure.rs = Instruct_in;
-    entryStructure.cur_dir = SET;
+    stateStructure.rs = Instruct_in;
+    stateStructure.cur_dir = SET;
 
-    uint8_t buf = 0x04;
-    buf |= entryStructure.disp_shift;
-    buf |= entryStructure.cur_dir << 1;
-
-    lcd_Write(buf , RESET);
-    Delay_Us(37);
+    lcd_Write(ENTRY_BYTE , RESET);
+    lcd_Exec(37);
 }
 
 /*********************************************************************
@@ -267,15 +330,11 @@ void entry_Right(void)
  */
 void entry_Left(void)
 {
-    dataStructure.rs = Instruct_in;
-    entryStructure.cur_dir = RESET;
+    stateStructure.rs = Instruct_in;
+    stateStructure.cur_dir = RESET;
 
-    uint8_t buf = 0x04;
-    buf |= entryStructure.disp_shift;
-    buf &= ~(1 << 1);
-
-    lcd_Write(buf , RESET);
-    Delay_Us(37);
+    lcd_Write(ENTRY_BYTE , RESET);
+    lcd_Exec(37);
 }
 
 /*********************************************************************
@@ -289,15 +348,11 @@ void entry_Left(void)
  */
 void display_Shift(void)
 {
-    dataStructure.rs = Instruct_in;
-    entryStructure.disp_shift = SET;
+    stateStructure.rs = Instruct_in;
+    stateStructure.disp_shift = SET;
 
-    uint8_t buf = 0x04;
-    buf |= entryStructure.disp_shift;
-    buf |= entryStructure.cur_dir << 1;
-
-    lcd_Write(buf , RESET);
-    Delay_Ms(2);
+    lcd_Write(ENTRY_BYTE , RESET);
+    lcd_Exec(2000);
 }
 
 /*********************************************************************
@@ -311,15 +366,11 @@ void display_Shift(void)
  */
 void nodisplay_Shift(void)
 {
-    dataStructure.rs = Instruct_in;
-    entryStructure.disp_shift = RESET;
+    stateStructure.rs = Instruct_in;
+    stateStructure.disp_shift = RESET;
 
-    uint8_t buf = 0x04;
-    buf &= ~(1);
-    buf |= entryStructure.cur_dir << 1;
-
-    lcd_Write(buf , RESET);
-    Delay_Us(37);
+    lcd_Write(ENTRY_BYTE , RESET);
+    lcd_Exec(37);
 }
 
 /*********************************************************************
@@ -333,10 +384,16 @@ void nodisplay_Shift(void)
  */
 void shift(void)
 {
-    dataStructure.rs = Instruct_in;
+    stateStructure.rs = Instruct_in;
 
-    lcd_Write(0x14 , RESET);
-    Delay_Us(37);
+    lcd_Write(LCD_SHIFT | 0x04 , RESET);
+    lcd_Exec(37);
+
+    for (uint8_t i = 0; i < LCD_CONTROLLERS; i++)
+    {
+        ac_Step(i, SET);
+    }
+    cur_col++;
 }
 
 /*********************************************************************
@@ -350,10 +407,16 @@ void shift(void)
  */
 void neg_Shift(void)
 {
-    dataStructure.rs = Instruct_in;
+    stateStructure.rs = Instruct_in;
+
+    lcd_Write(LCD_SHIFT , RESET);
+    lcd_Exec(37);
 
-    lcd_Write(0x10 , RESET);
-    Delay_Us(37);
+    for (uint8_t i = 0; i < LCD_CONTROLLERS; i++)
+    {
+        ac_Step(i, RESET);
+    }
+    cur_col--;
 }
 
 /*********************************************************************
@@ -367,10 +430,10 @@ void neg_Shift(void)
  */
 void shift_Disp(void)
 {
-    dataStructure.rs = Instruct_in;
+    stateStructure.rs = Instruct_in;
 
-    lcd_Write(0x1c , RESET);
-    Delay_Us(37);
+    lcd_Write(LCD_SHIFT | 0x0C , RESET);
+    lcd_Exec(37);
 }
 
 /*********************************************************************
@@ -384,16 +447,19 @@ void shift_Disp(void)
  */
 void negshift_Disp(void)
 {
-    dataStructure.rs = Instruct_in;
+    stateStructure.rs = Instruct_in;
 
-    lcd_Write(0x18 , RESET);
-    Delay_Us(37);
+    lcd_Write(LCD_SHIFT | 0x08 , RESET);
+    lcd_Exec(37);
 }
 
+#endif
+
+#if LCD_USE_BACKLIGHT
 /*********************************************************************
  * @fn      bclight_On
  *
- * @brief   Turns on the LCD backlight.
+ * @brief   Turns on the LCD backlight. Cancels any dimming or fade in progress.
  *
  * @param   None.
  *
@@ -401,17 +467,18 @@ void negshift_Disp(void)
  */
 void bclight_On(void)
 {
-    dataStructure.rs = Instruct_in;
-    dataStructure.Led = SET;
-
-    lcd_Write(0x00 , RESET);
-    Delay_Us(37);
+#if LCD_USE_PWM
+    bclight_Dim(BCLIGHT_PWM_LEVELS);
+#else
+    stateStructure.Led = SET;
+    bclight_Update();
+#endif
 }
 
 /*********************************************************************
  * @fn      bclight_Off
  *
- * @brief   Turns off the LCD backlight.
+ * @brief   Turns off the LCD backlight. Cancels any dimming or fade in progress.
  *
  * @param   None.
  *
@@ -419,179 +486,1548 @@ void bclight_On(void)
  */
 void bclight_Off(void)
 {
-    dataStructure.rs = Instruct_in;
-    dataStructure.Led = RESET;
-
-    lcd_Write(0x00 , RESET);
-    Delay_Us(37);
+#if LCD_USE_PWM
+    bclight_Dim(0);
+#else
+    stateStructure.Led = RESET;
+    bclight_Update();
+#endif
 }
 
+#if LCD_USE_PWM
 /*********************************************************************
- * @fn      lcd_Begin
+ * @fn      bclight_PwmBegin
  *
- * @brief   Initializes the LCD display with the specified row and column limits.
+ * @brief   Starts software PWM dimming of the backlight. TIM2 is set up to
+ *          tick at freq * BCLIGHT_PWM_LEVELS and toggles the LED bit of the
+ *          PCF8574 on each PWM edge with a single expander write.
+ *          With BCLIGHT_PWM_IRQ set to 0 the timer is left alone and
+ *          bclight_Tick() must be called at that rate by the application.
  *
- * @param   row_limit - Maximum number of rows the LCD can display.
- *          col_limit - Maximum number of columns the LCD can display.
+ * @param   freq - PWM frequency in Hz. ~100Hz is flicker free. 0 is
+ *                 ignored. The tick is slowed down to at least two
+ *                 expander writes per tick and at most 65536 us.
  *
  * @return  None.
  */
-void lcd_Begin(uint8_t row_limit , uint8_t col_limit)
+void bclight_PwmBegin(u32 freq)
 {
-    colmax = col_limit;
-    rowmax = row_limit;
+    if (freq == 0)
+    {
+        return;
+    }
 
-    uint8_t TextData[5] = { 30 , 30 , 30 , 20 , 40 };
+#if BCLIGHT_PWM_IRQ
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStructure={0};
+    NVIC_InitTypeDef NVIC_InitStructure={0};
+    uint32_t period = 1000000 / BCLIGHT_PWM_LEVELS / freq;
 
-    for (int i = 0 ; i < 5 ; i++)
+    if (period < 2 * (uint32_t)bus_us)
     {
-        lcd_Write(TextData[i], SET);
-        Delay_Ms(5);
+        period = 2 * (uint32_t)bus_us;
     }
-    display_On();
-    clear();
-    entry_Right();
-    home();
+    if (period < 2)
+    {
+        period = 2;
+    }
+    if (period > 65536)
+    {
+        period = 65536;
+    }
+
+    RCC_APB1PeriphClockCmd( RCC_APB1Periph_TIM2, ENABLE );
+
+    TIM_TimeBaseInitStructure.TIM_Prescaler = SystemCoreClock / 1000000 - 1;
+    TIM_TimeBaseInitStructure.TIM_Period = period - 1;
+    TIM_TimeBaseInitStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+    TIM_TimeBaseInitStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInit( TIM2, &TIM_TimeBaseInitStructure );
+    TIM_ITConfig( TIM2, TIM_IT_Update, ENABLE );
+
+    NVIC_InitStructure.NVIC_IRQChannel = TIM2_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init( &NVIC_InitStructure );
+#endif
+
+    pwm_phase = 0;
+    pwm_running = SET;
+
+#if BCLIGHT_PWM_IRQ
+    TIM_Cmd( TIM2, ENABLE );
+#endif
 }
 
 /*********************************************************************
- * @fn      convert
+ * @fn      bclight_Dim
  *
- * @brief   Converts a string into individual characters and writes them to the LCD.
+ * @brief   Sets the backlight brightness immediately. Without bclight_PwmBegin()
+ *          any non-zero level simply turns the backlight on.
  *
- * @param   sentence - The string to be written to the LCD.
+ * @param   level - Brightness, 0 (off) to BCLIGHT_PWM_LEVELS (fully on).
  *
  * @return  None.
  */
-void convert(const char *sentence)
+void bclight_Dim(uint8_t level)
 {
-    dataStructure.rs = Data_in;
-
-    for (int i = 0; i < strlen(sentence); i++) {
-        lcd_Write((uint8_t)sentence[i], RESET);
+    if (level > BCLIGHT_PWM_LEVELS)
+    {
+        level = BCLIGHT_PWM_LEVELS;
     }
+
+    pwm_target = level;
+    pwm_level = level;
+    pwm_led = (level > pwm_phase) ? SET : RESET;
+
+    stateStructure.Led = (level > 0) ? SET : RESET;
+    bclight_Update();
 }
 
 /*********************************************************************
- * @fn      set_Cursor
+ * @fn      bclight_Fade
  *
- * @brief   Sets the cursor position to the specified row and column.
+ * @brief   Fades the backlight towards a brightness level, one level at a time.
+ *          Needs bclight_PwmBegin(); text can be written while the fade runs.
  *
- * @param   row - Row number (0-based).
- *          col - Column number (0-based).
+ * @param   level        - Target brightness, 0 to BCLIGHT_PWM_LEVELS.
+ *          step_periods - PWM periods spent on each intermediate level.
  *
  * @return  None.
  */
-void set_Cursor(uint8_t row , uint8_t col)
+void bclight_Fade(uint8_t level, uint16_t step_periods)
 {
-    home();
+    if (!pwm_running || step_periods == 0)
+    {
+        bclight_Dim(level);
+        return;
+    }
+    if (level > BCLIGHT_PWM_LEVELS)
+    {
+        level = BCLIGHT_PWM_LEVELS;
+    }
 
-    uint8_t multi[4] = { 0x00 , 0x40 , 0x14 , 0x54 };
-    dataStructure.rs = Instruct_in;
+    fade_step = step_periods;
+    fade_count = 0;
+    pwm_target = level;
+}
 
-    if(col < colmax)
+/*********************************************************************
+ * @fn      bclight_Tick
+ *
+ * @brief   Advances the backlight PWM by one slot. Called from the TIM2
+ *          interrupt, or by the application when BCLIGHT_PWM_IRQ is 0.
+ *          The bus is only touched on PWM edges. If a text write is on the
+ *          bus at that moment the new LED state rides along with it instead.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+void bclight_Tick(void)
+{
+    if (++pwm_phase >= BCLIGHT_PWM_LEVELS)
     {
-        if(row < rowmax)
-        {
-            uint8_t buf = 0x80;
-            buf |= multi[row] + col;
+        pwm_phase = 0;
 
-            lcd_Write(buf, RESET);
-            Delay_Us(37);
+        if (pwm_level != pwm_target && ++fade_count >= fade_step)
+        {
+            fade_count = 0;
+            pwm_level += (pwm_target > pwm_level) ? 1 : -1;
         }
     }
+
+    uint8_t led = (pwm_phase < pwm_level) ? SET : RESET;
+    if (led != pwm_led)
+    {
+        pwm_led = led;
+        bclight_Update();
+    }
 }
 
+#if BCLIGHT_PWM_IRQ
+void TIM2_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+
 /*********************************************************************
- * @fn      custom_Char
+ * @fn      TIM2_IRQHandler
  *
- * @brief   Defines a custom character and stores it in the LCD's CGRAM.
- *          (Currently does not work properly.)
+ * @brief   Backlight PWM timer interrupt.
  *
- * @param   location - CGRAM location to store the custom character (0-7).
- *          charmap  - Array representing the character pixel pattern (8 bytes).
+ * @param   None.
  *
  * @return  None.
  */
-void custom_Char(uint8_t location, uint8_t charmap[]) {
-    location &= 0x07;
-
-    dataStructure.rs = Instruct_in;
-    lcd_Write(0x40 | (location << 3), RESET);
-    Delay_Us(37);
+void TIM2_IRQHandler(void)
+{
+    if (TIM_GetITStatus( TIM2, TIM_IT_Update ) != RESET)
+    {
+        TIM_ClearITPendingBit( TIM2, TIM_IT_Update );
+        bclight_Tick();
+    }
+}
+#endif
+#endif
 
-    dataStructure.rs = Data_in;
-    for (int i = 0; i < 8; i++) {
-        lcd_Write(charmap[i], RESET);
-        Delay_Us(37);
+/*********************************************************************
+ * @fn      bclight_Update
+ *
+ * @brief   Pushes the current LED state to the PCF8574 with one expander write.
+ *          E, RS and the data nibble are repeated from the last write, so the
+ *          HD44780 never sees a strobe. If the bus is in use the update is
+ *          left pending and sent by the transfer that holds it.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+static void bclight_Update(void)
+{
+    if (bus_busy)
+    {
+        bclight_pending = SET;
+        return;
     }
 
-    dataStructure.rs = Instruct_in;
-    lcd_Write(0x80, RESET);
-    Delay_Us(37);
+    uint8_t packet = bus_last;
+    expander_Write(&packet, 1);
 }
+#endif
 
 /*********************************************************************
- * @fn      i2c_Write
+ * @fn      lcd_Begin
  *
- * @brief   Sends a byte of data to the LCD via the I2C interface.
+ * @brief   Initializes the LCD display with the specified row and column limits.
+ *          Panels with more than 80 cells (40x4) are driven as two HD44780s,
+ *          E1 on P2 for rows 0-1 and E2 on P1 for rows 2-3; this needs
+ *          LCD_CONTROLLERS set to 2. Can be called again on a running
+ *          panel, e.g. to change the geometry.
  *
- * @param   packet - Data byte to be transmitted.
+ * @param   row_limit - Maximum number of rows the LCD can display.
+ *          col_limit - Maximum number of columns the LCD can display.
+ *
+ * @return  SET, or RESET when the geometry cannot be driven and was cut
+ *          down (see lcd_Geometry). A 40x4 panel without LCD_CONTROLLERS
+ *          at 2 then only shows rows 0 and 1.
+ */
+uint8_t lcd_Begin(uint8_t row_limit , uint8_t col_limit)
+{
+    uint8_t ok = lcd_Geometry(row_limit, col_limit);
+
+    lcd_Reset();
+    display_On();
+    clear();
+#if LCD_USE_SHIFT
+    entry_Right();
+#else
+    stateStructure.rs = Instruct_in;
+    lcd_Write(ENTRY_BYTE , RESET);
+    lcd_Exec(37);
+#endif
+    home();
+
+    return ok;
+}
+
+/*********************************************************************
+ * @fn      lcd_Attach
+ *
+ * @brief   Takes over a panel that is already running, e.g. after only the
+ *          MCU was reset, without clear(). The reset may have come between
+ *          the two nibbles of a byte, so the 4-bit interface is brought
+ *          back in step with the init sequence first; it leaves DDRAM as
+ *          it is. Display control and entry mode are then sent as
+ *          lcd_Begin() left them (display on, cursor and blink off, entry
+ *          to the right), followed by Return Home.
+ *          The driver's DDRAM copy starts blank; lcd_Resync(RESET) then
+ *          adopts what the panel shows.
+ *
+ * @param   row_limit - Maximum number of rows the LCD can display.
+ *          col_limit - Maximum number of columns the LCD can display.
+ *
+ * @return  SET, or RESET when the geometry was cut down, as lcd_Begin().
+ */
+uint8_t lcd_Attach(uint8_t row_limit, uint8_t col_limit)
+{
+    uint8_t ok = lcd_Geometry(row_limit, col_limit);
+
+    /* An instruction may still be running from before the reset */
+    lcd_Exec(2000);
+    lcd_Reset();
+
+    stateStructure.disp_state = SET;
+    stateStructure.cur_state = RESET;
+    stateStructure.blink_state = RESET;
+    stateStructure.cur_dir = cur_right;
+    stateStructure.disp_shift = RESET;
+    display_Control();
+
+    stateStructure.rs = Instruct_in;
+    lcd_Write(ENTRY_BYTE , RESET);
+    lcd_Exec(37);
+
+#if LCD_USE_SHADOW
+    memset(ddram_shadow, ' ', sizeof(ddram_shadow));
+#endif
+    home();
+
+    return ok;
+}
+
+/*********************************************************************
+ * @fn      lcd_Reset
+ *
+ * @brief   Puts the controllers in 4-bit mode, two lines, whatever state
+ *          the interface was in: three 8-bit Function Sets, then the
+ *          switch to 4 bits. A half-written byte is completed by the first
+ *          nibble. DDRAM and the display control are not changed.
+ *
+ * @param   None.
  *
  * @return  None.
  */
-void i2c_Write(uint8_t packet )
+static void lcd_Reset(void)
 {
-    while( I2C_GetFlagStatus( I2C1, I2C_FLAG_BUSY ) != RESET );
-    I2C_GenerateSTART( I2C1, ENABLE );
-    while( !I2C_CheckEvent( I2C1, I2C_EVENT_MASTER_MODE_SELECT ) );
-    I2C_Send7bitAddress(I2C1, TxAdderss, I2C_Direction_Transmitter);
+    uint8_t TextData[4] = { 0x30 , 0x30 , 0x30 , 0x20 };
 
-    while( !I2C_CheckEvent( I2C1, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED ) );
-    if( I2C_GetFlagStatus( I2C1, I2C_FLAG_TXE ) !=  RESET )
+    stateStructure.rs = Instruct_in;
+    for (int i = 0 ; i < 4 ; i++)
     {
-        Delay_Us(40);
-        I2C_SendData( I2C1 , packet );
-        while(!I2C_CheckEvent( I2C1, I2C_EVENT_MASTER_BYTE_TRANSMITTING));
+        lcd_Write(TextData[i], SET);
+        lcd_Delay(5000);
+    }
+    lcd_Write(LCD_FUNCTION | LCD_2LINE, RESET);
+    lcd_Exec(37);
+}
+
+/*********************************************************************
+ * @fn      lcd_Geometry
+ *
+ * @brief   Records the panel size and picks one or two controllers.
+ *          HD44780 panels have at most 4 rows of 40 columns; larger
+ *          sizes are clamped to that, which is also what the row buffers
+ *          (lcd_Resync) and the DDRAM copy are sized for. One controller
+ *          holds 80 cells, and its rows 2 and 3 only fit behind rows 0
+ *          and 1 up to 20 columns; wider panels with more than two rows
+ *          need two controllers, and without them are cut to two rows.
+ *
+ * @param   row_limit - Maximum number of rows the LCD can display.
+ *          col_limit - Maximum number of columns the LCD can display.
+ *
+ * @return  SET, or RESET when the geometry was cut down.
+ */
+static uint8_t lcd_Geometry(uint8_t row_limit, uint8_t col_limit)
+{
+    uint8_t ok = SET;
 
+    if (row_limit > 4)
+    {
+        row_limit = 4;
+        ok = RESET;
+    }
+    if (col_limit > 40)
+    {
+        col_limit = 40;
+        ok = RESET;
     }
 
-    while( !I2C_CheckEvent( I2C1, I2C_EVENT_MASTER_BYTE_TRANSMITTED ) );
-    I2C_GenerateSTOP( I2C1, ENABLE );
+#if LCD_CONTROLLERS > 1
+    lcd_dual = (row_limit * col_limit > 80) ? SET : RESET;
+    e_all = lcd_dual ? (E1_bit | E2_bit) : E1_bit;
+#endif
+    if (!lcd_dual && row_limit > 2 && col_limit > 20)
+    {
+        row_limit = 2;
+        ok = RESET;
+    }
+
+    colmax = col_limit;
+    rowmax = row_limit;
+    e_sel = e_all;
+
+    return ok;
 }
 
 /*********************************************************************
- * @fn      lcd_Write
+ * @fn      convert
  *
- * @brief   Writes a byte to the LCD and manages the high and low nibbles.
+ * @brief   Converts a string into individual characters and writes them to the LCD.
+ *          Text that reaches the end of a row continues on the next row.
  *
- * @param   packet - Data byte to be sent.
- *          init   - Flag indicating whether this is an initialization command.
+ * @param   sentence - The string to be written to the LCD.
  *
  * @return  None.
  */
-void lcd_Write(uint8_t packet , uint8_t init )
+void convert(const char *sentence)
+{
+    lcd_Print(sentence, strlen(sentence));
+}
+
+/*********************************************************************
+ * @fn      lcd_Print
+ *
+ * @brief   Writes len characters straight from the caller's buffer, starting
+ *          at the cursor. The buffer needs no terminating NUL. Text that
+ *          reaches the end of a row continues on the next row, and the last
+ *          row wraps to the first. With entry to the left the text runs
+ *          on through DDRAM as the controller steps.
+ *
+ * @param   text - Characters to be written.
+ *          len  - Number of characters.
+ *
+ * @return  None.
+ */
+void lcd_Print(const char *text, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++)
+    {
+        if (ac_valid[cur_ctrl] && cur_col >= colmax && ENTRY_RIGHT)
+        {
+            lcd_Goto((cur_row + 1 < rowmax) ? cur_row + 1 : 0, 0);
+        }
+        lcd_Data((uint8_t)text[i]);
+    }
+}
+
+/*********************************************************************
+ * @fn      lcd_PrintRing
+ *
+ * @brief   Writes len characters out of a ring buffer (UART receive buffer,
+ *          log FIFO...) without copying or re-terminating them.
+ *
+ * @param   ring  - Start of the ring buffer storage.
+ *          size  - Size of the ring buffer in bytes.
+ *          start - Index of the first character to write, taken modulo
+ *                  size so free running indexes can be passed.
+ *          len   - Number of characters, clipped to size.
+ *
+ * @return  None.
+ */
+void lcd_PrintRing(const char *ring, uint16_t size, uint16_t start, uint16_t len)
+{
+    if (size == 0)
+    {
+        return;
+    }
+    start %= size;
+    if (len > size)
+    {
+        len = size;
+    }
+
+    uint16_t first = size - start;
+
+    if (len <= first)
+    {
+        lcd_Print(&ring[start], len);
+        return;
+    }
+    lcd_Print(&ring[start], first);
+    lcd_Print(ring, len - first);
+}
+
+/*********************************************************************
+ * @fn      lcd_Block
+ *
+ * @brief   Lays text out in a rectangle of the display. Lines wrap at the
+ *          block width, '\n' starts a new line and text below the last
+ *          line is clipped. The DDRAM address is only set where the address
+ *          counter does not already point at the next cell, and on single
+ *          controller panels the lines are written in DDRAM address order
+ *          (rows 0, 2, 1, 3 on four line modules), so a full width block
+ *          needs a single jump. Cells the text does not reach are left
+ *          untouched.
+ *          On dual controller panels (with the cursor hidden) the rows of
+ *          the two controllers are written one character each in turn, so
+ *          each controller executes while the other is being fed.
+ *
+ * @param   row    - Top row of the block (0-based).
+ *          col    - Left column of the block (0-based).
+ *          width  - Block width in columns.
+ *          height - Block height in rows.
+ *          text   - Characters to be written, NUL not required.
+ *          len    - Number of characters.
+ *
+ * @return  Number of characters consumed from text. Less than len when the
+ *          rest was clipped.
+ */
+uint16_t lcd_Block(uint8_t row, uint8_t col, uint8_t width, uint8_t height, const char *text, uint16_t len)
 {
-    dataStructure.datapack = packet;
+    if (row >= rowmax || col >= colmax)
+    {
+        return 0;
+    }
+    if (width > colmax - col)
+    {
+        width = colmax - col;
+    }
+    if (height > rowmax - row)
+    {
+        height = rowmax - row;
+    }
+    if (height > 4)
+    {
+        height = 4;
+    }
 
-    dataStructure.E = SET;
-    i2c_Write(high_Data());
-    Delay_Us(1);
+    uint16_t start[4] = { 0 };
+    uint8_t count[4] = { 0 };
+    uint8_t used = 0;
+    uint16_t i = 0;
 
-    dataStructure.E = RESET;
-    i2c_Write(high_Data());
+    while (i < len && used < height)
+    {
+        if (text[i] == '\n')
+        {
+            i++;
+            if (++used < height)
+            {
+                start[used] = i;
+            }
+            continue;
+        }
+        if (count[used] >= width)
+        {
+            if (++used < height)
+            {
+                start[used] = i;
+            }
+            continue;
+        }
+        count[used]++;
+        i++;
+    }
+    if (used < height)
+    {
+        used++;
+    }
 
-        if (!init)
+    uint8_t order[4] = { 0, 1, 2, 3 };
+    uint8_t split = used;
+    if (lcd_dual)
+    {
+        if (row < 2 && !CURSOR_BITS)
+        {
+            split = (2 - row < used) ? 2 - row : used;
+        }
+    }
+    else
+    {
+        for (uint8_t n = 1; n < used; n++)
         {
-            Delay_Us(37);
+            uint8_t m = n;
+            while (m && row_Addr(row + order[m - 1]) > row_Addr(row + n))
+            {
+                order[m] = order[m - 1];
+                m--;
+            }
+            order[m] = n;
+        }
+    }
 
-            dataStructure.E = SET;
-            i2c_Write(low_Data());
-            Delay_Us(1);
+    uint8_t line[2] = { 0, split };
+    uint8_t end[2] = { split, used };
+    uint8_t x[2] = { 0, 0 };
 
-            dataStructure.E = RESET;
-            i2c_Write(low_Data());
+    while (line[0] < end[0] || line[1] < end[1])
+    {
+        for (uint8_t k = 0; k < 2; k++)
+        {
+            while (line[k] < end[k] && x[k] >= count[order[line[k]]])
+            {
+                line[k]++;
+                x[k] = 0;
+            }
+            if (line[k] >= end[k])
+            {
+                continue;
+            }
+
+            uint8_t n = order[line[k]];
+            lcd_Goto(row + n, col + x[k]);
+            lcd_Data((uint8_t)text[start[n] + x[k]]);
+            x[k]++;
         }
+    }
+    return i;
+}
+
+/*********************************************************************
+ * @fn      lcd_Put
+ *
+ * @brief   Writes raw character codes to consecutive cells of one row.
+ *          Unlike lcd_Print() and lcd_Block() no byte is treated as a
+ *          control character, so code 0x0A (an alias of CGRAM character 2)
+ *          is drawn like any other. Cells past the end of the row are
+ *          clipped.
+ *
+ * @param   row  - Row number (0-based).
+ *          col  - First column (0-based).
+ *          text - Character codes to be written.
+ *          len  - Number of cells.
+ *
+ * @return  None.
+ */
+void lcd_Put(uint8_t row, uint8_t col, const char *text, uint8_t len)
+{
+    if (row >= rowmax || col >= colmax)
+    {
+        return;
+    }
+    if (len > colmax - col)
+    {
+        len = colmax - col;
+    }
+
+    for (uint8_t x = 0; x < len; x++)
+    {
+        lcd_Goto(row, col + x);
+        lcd_Data((uint8_t)text[x]);
+    }
+}
+
+/*********************************************************************
+ * @fn      set_Cursor
+ *
+ * @brief   Sets the cursor position to the specified row and column.
+ *
+ * @param   row - Row number (0-based).
+ *          col - Column number (0-based).
+ *
+ * @return  None.
+ */
+void set_Cursor(uint8_t row , uint8_t col)
+{
+    home();
+
+    if(col < colmax)
+    {
+        if(row < rowmax)
+        {
+            lcd_Goto(row, col);
+        }
+    }
+}
+
+#if LCD_USE_SHADOW
+/*********************************************************************
+ * @fn      lcd_Cached
+ *
+ * @brief   Returns the character the driver last wrote to a cell. The copy is
+ *          kept for every character written through convert(), lcd_Print(),
+ *          lcd_Block() and lcd_Put(), and reset to blanks by clear().
+ *
+ * @param   row - Row number (0-based).
+ *          col - Column number (0-based).
+ *
+ * @return  Cached character code, 0 when the cell is outside the display.
+ */
+uint8_t lcd_Cached(uint8_t row, uint8_t col)
+{
+    if (row >= rowmax || col >= colmax)
+    {
+        return 0;
+    }
+
+    uint8_t ctrl = lcd_dual ? row >> 1 : 0;
+    uint8_t addr = row_Addr(row) + col;
+    return ddram_shadow[ctrl * 80 + ((addr & 0x40) ? 40 : 0) + (addr & 0x3F)];
+}
+#endif
+
+/*********************************************************************
+ * @fn      row_Addr
+ *
+ * @brief   DDRAM address of the first column of a row. Rows 2 and 3 continue
+ *          rows 0 and 1 right after the last visible column, which gives
+ *          0x14/0x54 on 20x4 and 0x10/0x50 on 16x4 modules. On dual
+ *          controller panels rows 2 and 3 are lines 1 and 2 of the second
+ *          controller.
+ *
+ * @param   row - Row number (0-based).
+ *
+ * @return  DDRAM address.
+ */
+static uint8_t row_Addr(uint8_t row)
+{
+    uint8_t addr = (row & 0x01) ? 0x40 : 0x00;
+
+    if ((row & 0x02) && !lcd_dual)
+    {
+        addr += colmax;
+    }
+    return addr;
+}
+
+/*********************************************************************
+ * @fn      lcd_Goto
+ *
+ * @brief   Moves the address counter to a cell. The Set DDRAM Address
+ *          instruction is skipped when the counter is already there.
+ *          On dual controller panels the cursor follows to the controller
+ *          that owns the row.
+ *
+ * @param   row - Row number (0-based).
+ *          col - Column number (0-based).
+ *
+ * @return  None.
+ */
+static void lcd_Goto(uint8_t row, uint8_t col)
+{
+    uint8_t ctrl = lcd_dual ? row >> 1 : 0;
+    uint8_t addr = row_Addr(row) + col;
+    uint8_t moved = (ctrl != cur_ctrl);
+
+    cur_row = row;
+    cur_col = col;
+    cur_ctrl = ctrl;
+
+    if (!ac_valid[ctrl] || ac_addr[ctrl] != addr)
+    {
+        stateStructure.rs = Instruct_in;
+        e_sel = E1_bit << ctrl;
+        lcd_Write(LCD_DDRAM | addr, RESET);
+        lcd_Exec(37);
+        e_sel = e_all;
+
+        ac_addr[ctrl] = addr;
+        ac_valid[ctrl] = SET;
+    }
+
+    if (moved && CURSOR_BITS)
+    {
+        display_Control();
+    }
+}
+
+/*********************************************************************
+ * @fn      lcd_Data
+ *
+ * @brief   Writes one character to DDRAM and follows the address counter.
+ *
+ * @param   packet - Character code.
+ *
+ * @return  None.
+ */
+static void lcd_Data(uint8_t packet)
+{
+    uint8_t ctrl = cur_ctrl;
+
+    stateStructure.rs = Data_in;
+    e_sel = E1_bit << ctrl;
+    lcd_Write(packet, RESET);
+    lcd_Exec(37);
+    e_sel = e_all;
+
+#if LCD_USE_SHADOW
+    if (ac_valid[ctrl] && (ac_addr[ctrl] & 0x3F) < 40)
+    {
+        ddram_shadow[ctrl * 80 + ((ac_addr[ctrl] & 0x40) ? 40 : 0) + (ac_addr[ctrl] & 0x3F)] = packet;
+    }
+#endif
+
+#if LCD_USE_SHIFT
+    if (!stateStructure.cur_dir)
+    {
+        ac_Step(ctrl, RESET);
+        cur_col--;
+        return;
+    }
+#endif
+
+    ac_Step(ctrl, SET);
+    cur_col++;
+}
+
+/*********************************************************************
+ * @fn      ac_Step
+ *
+ * @brief   Follows a controller's address counter by one cell, with the
+ *          two-line DDRAM wraps from 0x27 to 0x40 and from 0x67 to 0x00.
+ *
+ * @param   ctrl - Controller (0 or 1).
+ *          up   - SET to increment, RESET to decrement.
+ *
+ * @return  None.
+ */
+static void ac_Step(uint8_t ctrl, uint8_t up)
+{
+    uint8_t addr = ac_addr[ctrl];
+
+    if (up)
+    {
+        addr = (addr == 0x27) ? 0x40 : (addr == 0x67) ? 0x00 : addr + 1;
+    }
+    else
+    {
+        addr = (addr == 0x40) ? 0x27 : (addr == 0x00) ? 0x67 : addr - 1;
+    }
+    ac_addr[ctrl] = addr;
+}
+
+/*********************************************************************
+ * @fn      ac_Home
+ *
+ * @brief   Records that every controller's address counter is back at 0x00.
+ *          On dual controller panels the cursor goes back to the first
+ *          controller with it.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+static void ac_Home(void)
+{
+    uint8_t moved = (cur_ctrl != 0);
+
+    for (uint8_t i = 0; i < LCD_CONTROLLERS; i++)
+    {
+        ac_addr[i] = 0x00;
+        ac_valid[i] = SET;
+    }
+    cur_row = 0;
+    cur_col = 0;
+    cur_ctrl = 0;
+
+    if (lcd_dual && moved && CURSOR_BITS)
+    {
+        display_Control();
+    }
+}
+
+/*********************************************************************
+ * @fn      display_Control
+ *
+ * @brief   Sends the Display On/Off Control instruction built from
+ *          stateStructure. On dual controller panels only the controller
+ *          holding the cursor gets the cursor and blink bits.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+static void display_Control(void)
+{
+    uint8_t buf = LCD_DISPLAY | CURSOR_BITS | (stateStructure.disp_state << 2);
+
+    stateStructure.rs = Instruct_in;
+
+    if (lcd_dual)
+    {
+        e_sel = E1_bit << cur_ctrl;
+        lcd_Write(buf , RESET);
+        lcd_Exec(37);
+
+        e_sel = e_all & ~(E1_bit << cur_ctrl);
+        lcd_Write(buf & ~0x03 , RESET);
+        lcd_Exec(37);
+
+        e_sel = e_all;
+        return;
+    }
+
+    lcd_Write(buf , RESET);
+    lcd_Exec(37);
+}
+
+/*********************************************************************
+ * @fn      lcd_Exec
+ *
+ * @brief   Records the execution time of the instruction just written to the
+ *          selected controllers. Nothing waits here; the time is paid by the
+ *          next write to the same controller, minus whatever bus time has
+ *          passed in between. Writes to the other controller of a dual
+ *          panel therefore overlap with this one's execution.
+ *
+ * @param   us - Execution time in microseconds.
+ *
+ * @return  None.
+ */
+static void lcd_Exec(uint16_t us)
+{
+    for (uint8_t i = 0; i < LCD_CONTROLLERS; i++)
+    {
+        if (e_sel & (E1_bit << i))
+        {
+            exec_owed[i] = us;
+        }
+    }
+}
+
+/*********************************************************************
+ * @fn      lcd_Wait
+ *
+ * @brief   Waits until the selected controllers have finished their last
+ *          instruction, by the time E next rises. The START, the address
+ *          and the first data byte of the next transfer, 19 of the 20 bit
+ *          times of a single byte write, go out before that and are not
+ *          waited for.
+ *
+ * @param   sel - E1_bit and/or E2_bit.
+ *
+ * @return  None.
+ */
+static void lcd_Wait(uint8_t sel)
+{
+    uint16_t lead = 19 * bus_us / 20;
+    uint16_t us = 0;
+
+    for (uint8_t i = 0; i < LCD_CONTROLLERS; i++)
+    {
+        if ((sel & (E1_bit << i)) && exec_owed[i] > us)
+        {
+            us = exec_owed[i];
+        }
+    }
+    if (us <= lead)
+    {
+        return;
+    }
+    us -= lead;
+
+    lcd_Delay(us);
+    for (uint8_t i = 0; i < LCD_CONTROLLERS; i++)
+    {
+        exec_owed[i] = (exec_owed[i] > us) ? exec_owed[i] - us : 0;
+    }
+}
+
+#if LCD_USE_CGRAM
+/*********************************************************************
+ * @fn      custom_Char
+ *
+ * @brief   Defines a custom character and stores it in the LCD's CGRAM.
+ *          (Currently does not work properly.)
+ *
+ * @param   location - CGRAM location to store the custom character (0-7).
+ *          charmap  - Array representing the character pixel pattern (8 bytes).
+ *
+ * @return  None.
+ */
+void custom_Char(uint8_t location, uint8_t charmap[]) {
+    location &= 0x07;
+
+    stateStructure.rs = Instruct_in;
+    lcd_Write(LCD_CGRAM | (location << 3), RESET);
+    lcd_Exec(37);
+
+    stateStructure.rs = Data_in;
+    for (int i = 0; i < 8; i++) {
+        lcd_Write(charmap[i], RESET);
+        lcd_Exec(37);
+    }
+
+    stateStructure.rs = Instruct_in;
+    lcd_Write(LCD_DDRAM, RESET);
+    lcd_Exec(37);
+
+    ac_Home();
+}
+#endif
+
+#if LCD_USE_READ
+/*********************************************************************
+ * @fn      lcd_ReadData
+ *
+ * @brief   Reads DDRAM or CGRAM contents back from the LCD, starting at the
+ *          given address. The block is read in one bus transaction; the
+ *          bus only turns around between write and read phases with
+ *          repeated STARTs. The address counter is put back afterwards,
+ *          so printing carries on where the cursor was. With entry to the
+ *          left the read still runs upwards from addr. Not available on
+ *          40x4 panels.
+ *
+ * @param   addr - Set Address instruction to start from,
+ *                 LCD_DDRAM | ddram_address or LCD_CGRAM | cgram_address.
+ *          buf  - Receives the bytes read.
+ *          len  - Number of bytes to read.
+ *
+ * @return  Number of bytes read, 0 when readback is not available.
+ */
+uint8_t lcd_ReadData(uint8_t addr, uint8_t *buf, uint8_t len)
+{
+    uint8_t ac = ac_addr[0];
+
+    if (lcd_dual || len == 0)
+    {
+        return 0;
+    }
+
+    lcd_Wait(e_sel);
+    if (!ac_valid[0])
+    {
+        read_Block(Instruct_in, &ac, 1);
+        ac &= 0x7F;
+    }
+
+    stateStructure.rs = Instruct_in;
+#if LCD_USE_SHIFT
+    if (!stateStructure.cur_dir)
+    {
+        lcd_Write(LCD_ENTRY | stateStructure.disp_shift | (cur_right << 1), RESET);
+        lcd_Exec(37);
+    }
+#endif
+    lcd_Write(addr, RESET);
+    lcd_Exec(37);
+    lcd_Wait(e_sel);
+
+    read_Block(Data_in, buf, len);
+    lcd_Exec(37);
+
+#if LCD_USE_SHIFT
+    if (!stateStructure.cur_dir)
+    {
+        lcd_Write(ENTRY_BYTE, RESET);
+        lcd_Exec(37);
+    }
+#endif
+    lcd_Write(LCD_DDRAM | ac, RESET);
+    lcd_Exec(37);
+
+    return len;
+}
+
+/*********************************************************************
+ * @fn      lcd_ReadAddress
+ *
+ * @brief   Reads the address counter back from the LCD. Not available on
+ *          40x4 panels.
+ *
+ * @param   None.
+ *
+ * @return  Address counter (7 bits), 0xFF when readback is not available.
+ */
+uint8_t lcd_ReadAddress(void)
+{
+    uint8_t ac;
+
+    if (lcd_dual)
+    {
+        return 0xFF;
+    }
+
+    lcd_Wait(e_sel);
+    read_Block(Instruct_in, &ac, 1);
+
+    return ac & 0x7F;
+}
+
+#if LCD_USE_SHADOW
+/*********************************************************************
+ * @fn      lcd_Resync
+ *
+ * @brief   Reads the visible DDRAM back, one block per row, and compares it
+ *          with the driver's copy (lcd_Cached). Use it after a brown-out or
+ *          after another master touched the bus; the panel must still be
+ *          initialised. After an MCU reset call lcd_Attach() first.
+ *          With repair set, only the cells that differ are rewritten from
+ *          the copy. Without it the copy is rebuilt from the panel, and
+ *          widgets can then be brought back with screen_Invalidate() and
+ *          screen_Update(), which again send only the differing cells.
+ *
+ * @param   repair - SET to fix the panel, RESET to adopt its contents.
+ *
+ * @return  Number of cells that differed, 0xFF when readback is not
+ *          available.
+ */
+uint8_t lcd_Resync(uint8_t repair)
+{
+    uint8_t line[40];
+    uint8_t diff = 0;
+
+    if (lcd_dual)
+    {
+        return 0xFF;
+    }
+
+    for (uint8_t row = 0; row < rowmax; row++)
+    {
+        uint8_t addr = row_Addr(row);
+        uint8_t *cache = &ddram_shadow[((addr & 0x40) ? 40 : 0) + (addr & 0x3F)];
+
+        lcd_ReadData(LCD_DDRAM | addr, line, colmax);
+
+        uint8_t x = 0;
+        while (x < colmax)
+        {
+            if (line[x] == cache[x])
+            {
+                x++;
+                continue;
+            }
+
+            uint8_t start = x;
+            while (x < colmax && line[x] != cache[x])
+            {
+                x++;
+            }
+            diff += x - start;
+
+            if (repair)
+            {
+                lcd_Put(row, start, (const char *)&cache[start], x - start);
+            }
+            else
+            {
+                memcpy(&cache[start], &line[start], x - start);
+            }
+        }
+    }
+    return diff;
+}
+#endif
+
+/*********************************************************************
+ * @fn      read_Block
+ *
+ * @brief   Reads bytes from the HD44780 through the PCF8574. Each nibble is
+ *          strobed with E high, the port is read with a repeated START in
+ *          receive mode, and E goes low again in the next write phase.
+ *          The data pins are written high so the PCF8574 can read them,
+ *          and RW (P1) is held high until the last byte of the block.
+ *          Data reads are spaced by the 37 us the controller takes for
+ *          each one; the caller still owes it after the last.
+ *
+ * @param   rs  - Data_in for DDRAM/CGRAM data, Instruct_in for the address.
+ *          buf - Receives the bytes read.
+ *          len - Number of bytes to read.
+ *
+ * @return  None.
+ */
+static void read_Block(uint8_t rs, uint8_t *buf, uint8_t len)
+{
+    uint8_t port = 0xF0 | (read_bit << 1) | rs;
+    /* A RAM read runs 37 us; one byte phase (9 of 20 bits) passes before the next */
+    uint16_t gap = (rs && 9 * bus_us / 20 < 37) ? 37 - 9 * bus_us / 20 : 0;
+
+#if LCD_USE_BACKLIGHT
+    bus_busy = SET;
+    bclight_pending = RESET;
+#endif
+
+#if LCD_LOWPOWER
+    bus_slept = (__get_MSTATUS() & 0x08) ? SET : RESET;
+    while( I2C_GetFlagStatus( I2C1, I2C_FLAG_BUSY ) != RESET )
+    {
+        bus_slept = RESET;
+    }
+#else
+    while( I2C_GetFlagStatus( I2C1, I2C_FLAG_BUSY ) != RESET );
+#endif
+    I2C_GenerateSTART( I2C1, ENABLE );
+    i2c_Wait( I2C_EVENT_MASTER_MODE_SELECT );
+    I2C_Send7bitAddress( I2C1, TxAdderss, I2C_Direction_Transmitter );
+    i2c_Wait( I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED );
+
+    I2C_SendData( I2C1, port | (LED_STATE << 3) );
+    i2c_Wait( I2C_EVENT_MASTER_BYTE_TRANSMITTED );
+
+    for (uint8_t i = 0; i < len; i++)
+    {
+        uint8_t value = 0;
+
+        if (i && gap)
+        {
+            lcd_Delay(gap);
+        }
+
+        for (uint8_t nibble = 0; nibble < 2; nibble++)
+        {
+            I2C_SendData( I2C1, port | (LED_STATE << 3) | (E1_bit << 2) );
+            i2c_Wait( I2C_EVENT_MASTER_BYTE_TRANSMITTED );
+
+            I2C_GenerateSTART( I2C1, ENABLE );
+            i2c_Wait( I2C_EVENT_MASTER_MODE_SELECT );
+            I2C_AcknowledgeConfig( I2C1, DISABLE );
+            I2C_Send7bitAddress( I2C1, TxAdderss, I2C_Direction_Receiver );
+            i2c_Wait( I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED );
+            I2C_GenerateSTART( I2C1, ENABLE );
+            i2c_Wait( I2C_EVENT_MASTER_BYTE_RECEIVED );
+            value = (value << 4) | (I2C_ReceiveData( I2C1 ) >> 4);
+            I2C_AcknowledgeConfig( I2C1, ENABLE );
+
+            i2c_Wait( I2C_EVENT_MASTER_MODE_SELECT );
+            I2C_Send7bitAddress( I2C1, TxAdderss, I2C_Direction_Transmitter );
+            i2c_Wait( I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED );
+
+            I2C_SendData( I2C1, port | (LED_STATE << 3) );
+            i2c_Wait( I2C_EVENT_MASTER_BYTE_TRANSMITTED );
+        }
+        buf[i] = value;
+    }
+
+    port = rs | (LED_STATE << 3);
+    I2C_SendData( I2C1, port );
+    i2c_Wait( I2C_EVENT_MASTER_BYTE_TRANSMITTED );
+    I2C_GenerateSTOP( I2C1, ENABLE );
+
+#if LCD_USE_STATS
+    /* S+addr+byte, then per nibble byte+Sr+addr+byte+Sr+addr+byte, then byte+P */
+    uint32_t bus_time = (29 + 94 * (uint32_t)len) * bus_us / 20;
+    STATS_ADD(bus_bytes, 2 + 6 * (uint32_t)len);
+    STATS_ADD(bus_us, bus_time);
+#if LCD_LOWPOWER
+    if (bus_slept)
+    {
+        STATS_ADD(sleep_us, bus_time);
+    }
+    else
+#endif
+    {
+        STATS_ADD(spin_us, bus_time);
+    }
+#endif
+
+#if LCD_USE_BACKLIGHT
+    bus_last = port;
+    bus_busy = RESET;
+    if (bclight_pending)
+    {
+        expander_Write(&port, 1);
+    }
+#endif
+}
+#endif
+
+/*********************************************************************
+ * @fn      lcd_Delay
+ *
+ * @brief   Waits for the LCD. With LCD_LOWPOWER the core sleeps (WFI) until
+ *          a SysTick compare interrupt, otherwise it spins in Delay_Us().
+ *          Inside interrupt handlers, or with interrupts disabled, it
+ *          always spins.
+ *
+ * @param   us - Time to wait in microseconds.
+ *
+ * @return  None.
+ */
+static void lcd_Delay(uint32_t us)
+{
+#if LCD_LOWPOWER
+    if (__get_MSTATUS() & 0x08)
+    {
+        STATS_ADD(sleep_us, us);
+
+        lcd_tick_done = RESET;
+        SysTick->SR &= ~(1 << 0);
+        SysTick->CMP = us * (SystemCoreClock / 8000000);
+        SysTick->CNT = 0;
+        NVIC_EnableIRQ( SysTicK_IRQn );
+        SysTick->CTLR |= (1 << 1) | (1 << 0);
+
+        __disable_irq();
+        while (!lcd_tick_done)
+        {
+            __WFI();
+            __enable_irq();
+            __disable_irq();
+        }
+        __enable_irq();
+
+        SysTick->CTLR &= ~((1 << 1) | (1 << 0));
+        NVIC_DisableIRQ( SysTicK_IRQn );
+        return;
+    }
+#endif
+
+    STATS_ADD(spin_us, us);
+    Delay_Us(us);
+}
+
+/*********************************************************************
+ * @fn      i2c_Wait
+ *
+ * @brief   Waits for an I2C master event. With LCD_LOWPOWER the core sleeps
+ *          until the I2C event interrupt, otherwise it spins.
+ *
+ * @param   event - I2C_EVENT_MASTER_xxx to wait for.
+ *
+ * @return  None.
+ */
+static void i2c_Wait(uint32_t event)
+{
+#if LCD_LOWPOWER
+    if (__get_MSTATUS() & 0x08)
+    {
+        uint16_t it = I2C_IT_EVT;
+
+        /* TXE and RXNE only raise the event interrupt with ITBUFEN set */
+        if (event == I2C_EVENT_MASTER_BYTE_TRANSMITTING || event == I2C_EVENT_MASTER_BYTE_RECEIVED)
+        {
+            it |= I2C_IT_BUF;
+        }
+
+        __disable_irq();
+        while( !I2C_CheckEvent( I2C1, event ) )
+        {
+            I2C_ITConfig( I2C1, it, ENABLE );
+            __WFI();
+            __enable_irq();
+            __disable_irq();
+        }
+        __enable_irq();
+        return;
+    }
+#endif
+
+    while( !I2C_CheckEvent( I2C1, event ) );
+}
+
+#if LCD_LOWPOWER
+/*********************************************************************
+ * @fn      lcd_SysTick
+ *
+ * @brief   Wakes lcd_Delay() when the wait is over. Called from
+ *          SysTick_Handler.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+void lcd_SysTick(void)
+{
+    SysTick->SR &= ~(1 << 0);
+    lcd_tick_done = SET;
+}
+
+/*********************************************************************
+ * @fn      lcd_I2cEvent
+ *
+ * @brief   Wakes i2c_Wait(). The event and buffer interrupts are masked
+ *          again here, since the flags stay set until i2c_Wait() has
+ *          handled them. Called from I2C1_EV_IRQHandler.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+void lcd_I2cEvent(void)
+{
+    I2C_ITConfig( I2C1, I2C_IT_EVT | I2C_IT_BUF, DISABLE );
+}
+
+#if LCD_LOWPOWER_IRQ
+void SysTick_Handler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+void I2C1_EV_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+
+/*********************************************************************
+ * @fn      SysTick_Handler
+ *
+ * @brief   SysTick interrupt, only used by lcd_Delay().
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+void SysTick_Handler(void)
+{
+    lcd_SysTick();
+}
+
+/*********************************************************************
+ * @fn      I2C1_EV_IRQHandler
+ *
+ * @brief   I2C1 event interrupt, only used by i2c_Wait().
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+void I2C1_EV_IRQHandler(void)
+{
+    lcd_I2cEvent();
+}
+#endif
+#endif
+
+#if LCD_USE_STATS
+/*********************************************************************
+ * @fn      stats_Reset
+ *
+ * @brief   Clears the operation, bus and wait counters in statsStructure.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+void stats_Reset(void)
+{
+    memset(&statsStructure, 0, sizeof(statsStructure));
+}
+
+/*********************************************************************
+ * @fn      stats_Energy
+ *
+ * @brief   Estimates the MCU energy spent per LCD operation (lcd_Write) from
+ *          the time counted in statsStructure: spinning at LCD_RUN_UA, sleeping
+ *          at LCD_SLEEP_UA, both at LCD_VDD_MV. Only the waiting is counted,
+ *          which is the part LCD_LOWPOWER changes.
+ *
+ * @param   None.
+ *
+ * @return  Energy per operation in nanojoules.
+ */
+uint32_t stats_Energy(void)
+{
+    if (statsStructure.ops == 0)
+    {
+        return 0;
+    }
+
+    uint64_t fj = (uint64_t)statsStructure.spin_us * LCD_RUN_UA * LCD_VDD_MV;
+    fj += (uint64_t)statsStructure.sleep_us * LCD_SLEEP_UA * LCD_VDD_MV;
+
+    return (uint32_t)(fj / 1000000 / statsStructure.ops);
+}
+#endif
+
+/*********************************************************************
+ * @fn      i2c_Write
+ *
+ * @brief   Sends a byte of data to the LCD via the I2C interface.
+ *          The bus time of the transfer counts towards the execution time
+ *          the controllers still owe.
+ *
+ * @param   packet - Data byte to be transmitted.
+ *
+ * @return  None.
+ */
+void i2c_Write(uint8_t packet )
+{
+    i2c_Send(&packet, 1);
+}
+
+/*********************************************************************
+ * @fn      i2c_Send
+ *
+ * @brief   Sends bytes to the PCF8574 in one transfer and counts its bus
+ *          time, START + address + 9 bits per byte + STOP, towards the
+ *          execution time the controllers still owe.
+ *
+ * @param   packets - Expander output bytes.
+ *          len     - Number of bytes.
+ *
+ * @return  None.
+ */
+static void i2c_Send(const uint8_t *packets, uint8_t len)
+{
+    uint16_t us = (11 + 9 * (uint16_t)len) * bus_us / 20;
+
+    expander_Write(packets, len);
+
+    for (uint8_t i = 0; i < LCD_CONTROLLERS; i++)
+    {
+        exec_owed[i] = (exec_owed[i] > us) ? exec_owed[i] - us : 0;
+    }
+
+    STATS_ADD(bus_bytes, len);
+    STATS_ADD(bus_us, us);
+#if LCD_LOWPOWER
+    if (bus_slept)
+    {
+        STATS_ADD(sleep_us, us);
+    }
+    else
+#endif
+    {
+        STATS_ADD(spin_us, us);
+    }
+}
+
+/*********************************************************************
+ * @fn      expander_Write
+ *
+ * @brief   Writes bytes to the PCF8574 outputs, one after the other in a
+ *          single transfer; the outputs change at the acknowledge of each.
+ *          The LED bit is always taken from the current backlight state,
+ *          so PWM edges that happen while the bus is busy are not lost.
+ *
+ * @param   packets - Expander output bytes.
+ *          len     - Number of bytes.
+ *
+ * @return  None.
+ */
+static void expander_Write(const uint8_t *packets, uint8_t len)
+{
+    uint8_t packet = 0;
+
+#if LCD_USE_BACKLIGHT
+    bus_busy = SET;
+    bclight_pending = RESET;
+#endif
+
+#if LCD_LOWPOWER
+    bus_slept = (__get_MSTATUS() & 0x08) ? SET : RESET;
+    while( I2C_GetFlagStatus( I2C1, I2C_FLAG_BUSY ) != RESET )
+    {
+        bus_slept = RESET;
+    }
+#else
+    while( I2C_GetFlagStatus( I2C1, I2C_FLAG_BUSY ) != RESET );
+#endif
+    I2C_GenerateSTART( I2C1, ENABLE );
+    i2c_Wait( I2C_EVENT_MASTER_MODE_SELECT );
+    I2C_Send7bitAddress(I2C1, TxAdderss, I2C_Direction_Transmitter);
+
+    i2c_Wait( I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED );
+    for (uint8_t i = 0; i < len; i++)
+    {
+        packet = (packets[i] & ~(1 << 3)) | (LED_STATE << 3);
+
+        I2C_SendData( I2C1 , packet );
+        i2c_Wait( I2C_EVENT_MASTER_BYTE_TRANSMITTED );
+    }
+    I2C_GenerateSTOP( I2C1, ENABLE );
+
+#if LCD_USE_BACKLIGHT
+    bus_last = packet;
+    bus_busy = RESET;
+    if (bclight_pending)
+    {
+        expander_Write(&packet, 1);
+    }
+#endif
+}
+
+/*********************************************************************
+ * @fn      lcd_Write
+ *
+ * @brief   Writes a byte to the LCD and manages the high and low nibbles.
+ *          Strobes the E lines selected by the last lcd_Begin (both on dual
+ *          controller panels) after the previous instruction has finished.
+ *          The E high and E low expander writes of both nibbles go out in
+ *          one I2C transfer. Each write outlasts the E pulse width, and
+ *          4-bit mode needs no delay between the two nibbles.
+ *
+ * @param   packet - Data byte to be sent.
+ *          init   - Flag indicating whether this is an initialization command.
+ *
+ * @return  None.
+ */
+void lcd_Write(uint8_t packet , uint8_t init )
+{
+    uint8_t buf[4];
+
+    STATS_ADD(ops, 1);
+    lcd_Wait(e_sel);
+    datapack = packet;
+
+    e_pins = e_sel;
+    buf[0] = high_Data();
+
+    e_pins = RESET;
+    buf[1] = high_Data();
+
+    if (!init)
+    {
+        e_pins = e_sel;
+        buf[2] = low_Data();
+
+        e_pins = RESET;
+        buf[3] = low_Data();
+    }
+
+    i2c_Send(buf, init ? 2 : 4);
 }
 
 /*********************************************************************
@@ -606,11 +2042,11 @@ void lcd_Write(uint8_t packet , uint8_t init )
 uint8_t low_Data(void)
 {
 
-    uint8_t buf = dataStructure.rs;
-    buf |= 0 << 1;
-    buf |= dataStructure.E << 2;
-    buf |= dataStructure.Led << 3;
-    buf |= ((dataStructure.datapack & 0x0F) << 4);
+    uint8_t buf = stateStructure.rs;
+    buf |= (e_pins >> 1) << 1;
+    buf |= (e_pins & E1_bit) << 2;
+    buf |= LED_STATE << 3;
+    buf |= ((datapack & 0x0F) << 4);
 
     return buf;
 }
@@ -627,11 +2063,11 @@ uint8_t low_Data(void)
 uint8_t high_Data(void)
 {
 
-    uint8_t buf = dataStructure.rs;
-    buf |= 0 << 1;
-    buf |= dataStructure.E << 2;
-    buf |= dataStructure.Led << 3;
-    buf |= dataStructure.datapack & 0xF0;
+    uint8_t buf = stateStructure.rs;
+    buf |= (e_pins >> 1) << 1;
+    buf |= (e_pins & E1_bit) << 2;
+    buf |= LED_STATE << 3;
+    buf |= datapack & 0xF0;
 
     return buf;
 }
@@ -20,36 +20,37 @@ extern "C" {
 #include <ch32v00x.h>
 #include <ch32v00x_i2c.h>
 #include <ch32v00x_rcc.h>
+#include <I2C_LCD_conf.h>
 
 #define TxAdderss   0x4E
 
 typedef struct
 {
-    uint8_t rs;
-    uint8_t E;
-    uint8_t Led;
-    uint8_t datapack;
+    uint8_t rs          : 1;
+    uint8_t Led         : 1;
+    uint8_t disp_state  : 1;
+    uint8_t cur_state   : 1;
+    uint8_t blink_state : 1;
+    uint8_t cur_dir     : 1;
+    uint8_t disp_shift  : 1;
+    uint8_t             : 1;
 
-} dataTypeDef;
+} stateTypeDef;
 
 typedef struct
 {
-    uint8_t disp_state;
-    uint8_t cur_state;
-    uint8_t blink_state;
+    uint32_t ops;
+    uint32_t bus_bytes;
+    uint32_t bus_us;
+    uint32_t spin_us;
+    uint32_t sleep_us;
 
-} displayTypeDef;
+} statsTypeDef;
 
-typedef struct
-{
-    uint8_t cur_dir;
-    uint8_t disp_shift;
-
-} entryTypeDef;
-
-extern dataTypeDef dataStructure;
-extern displayTypeDef displayStructure;
-extern entryTypeDef entryStructure;
+extern stateTypeDef stateStructure;
+#if LCD_USE_STATS
+extern statsTypeDef statsStructure;
+#endif
 
 #define Data_in                     ((uint8_t)0x01)
 #define Instruct_in                 ((uint8_t)0x00)
@@ -60,15 +61,31 @@ extern entryTypeDef entryStructure;
 #define cur_right                   ((uint8_t)0x01)
 #define cur_left                    ((uint8_t)0x00)
 
+#define E1_bit                      ((uint8_t)0x01)
+#define E2_bit                      ((uint8_t)0x02)
+
+#define LCD_CLEAR                   ((uint8_t)0x01)
+#define LCD_HOME                    ((uint8_t)0x02)
+#define LCD_ENTRY                   ((uint8_t)0x04)
+#define LCD_DISPLAY                 ((uint8_t)0x08)
+#define LCD_SHIFT                   ((uint8_t)0x10)
+#define LCD_FUNCTION                ((uint8_t)0x20)
+#define LCD_2LINE                   ((uint8_t)0x08)
+#define LCD_CGRAM                   ((uint8_t)0x40)
+#define LCD_DDRAM                   ((uint8_t)0x80)
+
 void i2c_Begin(u32 bound, uint8_t address);
 void clear(void);
 void home(void);
 void display_On(void);
 void display_Off(void);
+#if LCD_USE_CURSOR
 void cursor_On(void);
 void cursor_Off(void);
 void blink_On(void);
 void blink_Off(void);
+#endif
+#if LCD_USE_SHIFT
 void entry_Right(void);
 void entry_Left(void);
 void display_Shift(void);
@@ -77,15 +94,53 @@ void shift(void);
 void neg_Shift(void);
 void shift_Disp(void);
 void negshift_Disp(void);
+#endif
+#if LCD_USE_BACKLIGHT
 void bclight_On(void);
 void bclight_Off(void);
-void lcd_Begin(uint8_t row_limit, uint8_t col_limit);
+#endif
+#if LCD_USE_PWM
+void bclight_PwmBegin(u32 freq);
+void bclight_Dim(uint8_t level);
+void bclight_Fade(uint8_t level, uint16_t step_periods);
+void bclight_Tick(void);
+#endif
+uint8_t lcd_Begin(uint8_t row_limit, uint8_t col_limit);
+uint8_t lcd_Attach(uint8_t row_limit, uint8_t col_limit);
 void convert(const char *sentence);
+void lcd_Print(const char *text, uint16_t len);
+void lcd_PrintRing(const char *ring, uint16_t size, uint16_t start, uint16_t len);
+uint16_t lcd_Block(uint8_t row, uint8_t col, uint8_t width, uint8_t height, const char *text, uint16_t len);
+void lcd_Put(uint8_t row, uint8_t col, const char *text, uint8_t len);
 void set_Cursor(uint8_t row, uint8_t col);
+#if LCD_USE_SHADOW
+uint8_t lcd_Cached(uint8_t row, uint8_t col);
+#endif
+#if LCD_LOWPOWER
+void lcd_SysTick(void);
+void lcd_I2cEvent(void);
+#endif
+#if LCD_USE_STATS
+void stats_Reset(void);
+uint32_t stats_Energy(void);
+#endif
+#if LCD_USE_CGRAM
 void custom_Char(uint8_t location, uint8_t charmap[]);
+#endif
+#if LCD_USE_READ
+uint8_t lcd_ReadData(uint8_t addr, uint8_t *buf, uint8_t len);
+uint8_t lcd_ReadAddress(void);
+#if LCD_USE_SHADOW
+uint8_t lcd_Resync(uint8_t repair);
+#endif
+#endif
 void i2c_Write(uint8_t packet);
 void lcd_Write(uint8_t packet, uint8_t init);
 uint8_t low_Data(void);
 uint8_t high_Data(void);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* INC_I2C_LCD_H_ */
@@ -0,0 +1,101 @@
+/********************************** (C) COPYRIGHT  *******************************
+ * File Name          : I2C_LCD_conf.h
+ * Author             : Hiranya Keshan
+ * Version            : V1.0.0
+ * Date               : 2024/10/08
+ * Description        : Build configuration of the I2C LCD firmware library.
+ *                      Set a feature to 0 to compile it out completely.
+ *                      Every setting can also be given on the compiler
+ *                      command line, e.g. -DLCD_USE_CGRAM=0.
+ *                      I2C_LCD_conf.h in Project -> Peripheral -> inc
+ *********************************************************************************/
+
+#ifndef INC_I2C_LCD_CONF_H_
+#define INC_I2C_LCD_CONF_H_
+
+/* cursor_On/Off, blink_On/Off. Off -> cursor and blink stay hidden. */
+#ifndef LCD_USE_CURSOR
+#define LCD_USE_CURSOR              1
+#endif
+
+/* entry_Left/Right, (no)display_Shift, shift, neg_Shift, (neg)shift_Disp.
+ * Off -> entry mode is fixed to cursor right, no display shift. */
+#ifndef LCD_USE_SHIFT
+#define LCD_USE_SHIFT               1
+#endif
+
+/* custom_Char. */
+#ifndef LCD_USE_CGRAM
+#define LCD_USE_CGRAM               1
+#endif
+
+/* bclight_On/Off. Off -> backlight is always on. */
+#ifndef LCD_USE_BACKLIGHT
+#define LCD_USE_BACKLIGHT           1
+#endif
+
+/* lcd_ReadData, lcd_ReadAddress and lcd_Resync. Needs RW on P1, so it is
+ * not available on 40x4 panels where P1 drives E2. */
+#ifndef LCD_USE_READ
+#define LCD_USE_READ                1
+#endif
+
+/* Backlight PWM dimming and fades, needs LCD_USE_BACKLIGHT. Uses TIM2. */
+#ifndef LCD_USE_PWM
+#define LCD_USE_PWM                 1
+#endif
+
+/* Driver copy of DDRAM (lcd_Cached), 80 bytes of RAM per controller.
+ * Needed by LCD_Widget.c. */
+#ifndef LCD_USE_SHADOW
+#define LCD_USE_SHADOW              1
+#endif
+
+/* statsStructure counters and stats_Energy(). */
+#ifndef LCD_USE_STATS
+#define LCD_USE_STATS               1
+#endif
+
+/* 1 -> single HD44780 only, 2 -> also 40x4 panels with E2 on P1
+ * (about 600 B of flash and 84 B of RAM more). */
+#ifndef LCD_CONTROLLERS
+#define LCD_CONTROLLERS             1
+#endif
+
+/* 1 -> WFI during LCD and I2C waits. */
+#ifndef LCD_LOWPOWER
+#define LCD_LOWPOWER                0
+#endif
+
+/* With LCD_LOWPOWER the library defines SysTick_Handler and
+ * I2C1_EV_IRQHandler itself. 0 -> it does not, and the application's own
+ * handlers must call lcd_SysTick() and lcd_I2cEvent(). */
+#ifndef LCD_LOWPOWER_IRQ
+#define LCD_LOWPOWER_IRQ            1
+#endif
+
+/* Energy estimate: supply voltage, MCU current while spinning and in sleep. */
+#ifndef LCD_VDD_MV
+#define LCD_VDD_MV                  3300
+#endif
+#ifndef LCD_RUN_UA
+#define LCD_RUN_UA                  5000
+#endif
+#ifndef LCD_SLEEP_UA
+#define LCD_SLEEP_UA                1800
+#endif
+
+#ifndef BCLIGHT_PWM_LEVELS
+#define BCLIGHT_PWM_LEVELS          16
+#endif
+
+/* 0 -> call bclight_Tick() from your own timer. */
+#ifndef BCLIGHT_PWM_IRQ
+#define BCLIGHT_PWM_IRQ             1
+#endif
+
+#if LCD_USE_PWM && !LCD_USE_BACKLIGHT
+#error "LCD_USE_PWM needs LCD_USE_BACKLIGHT"
+#endif
+
+#endif /* INC_I2C_LCD_CONF_H_ */
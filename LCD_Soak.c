@@ -0,0 +1,516 @@
+/********************************** (C) COPYRIGHT  *******************************
+ * File Name          : LCD_Soak.c
+ * Author             : Hiranya Keshan
+ * Version            : V1.0.0
+ * Date               : 2024/10/08
+ * Description        : This file provides a soak test for the I2C LCD library.
+ *                      It runs a long random mix of convert, set_Cursor,
+ *                      clear, custom_Char, control and backlight calls on
+ *                      random geometries up to 20x4, keeps its own model of
+ *                      DDRAM and CGRAM, and reads the panel back to check it.
+ *                      Throughput is timed with soak_Clock(), which the
+ *                      application provides (a timer on the target, the
+ *                      panel model's clock in the host build under
+ *                      tools/host), and the CPU time with SOAK_CPU_CLOCK.
+ *                      LCD_Soak.c in Project -> Peripheral -> src
+ *********************************************************************************/
+
+#include <LCD_Soak.h>
+#include <string.h>
+
+static uint32_t soak_seed;
+static uint8_t rows;
+static uint8_t cols;
+static uint8_t m_row;
+static uint8_t m_col;
+static uint8_t m_ac;
+static uint8_t m_ddram[128];
+#if LCD_USE_CGRAM
+static uint8_t m_cgram[64];
+static uint8_t m_cg_used;
+#endif
+static uint32_t window_start;
+static uint32_t window_cpu;
+static uint64_t total_us;
+static uint64_t total_cpu_us;
+static uint64_t total_lcd_us;
+static uint64_t total_bus_us;
+static uint64_t total_sleep_us;
+static uint64_t total_nj;
+static uint64_t total_lcd_ops;
+
+static uint32_t soak_Rand(void);
+static uint8_t soak_Addr(uint8_t row);
+static void soak_Session(uint8_t max_rows, uint8_t max_cols);
+static void soak_Op(void);
+static void soak_Text(void);
+static uint32_t soak_Check(void);
+static uint32_t soak_Window(uint32_t *cpu_us);
+
+/*********************************************************************
+ * @fn      soak_Run
+ *
+ * @brief   Runs the soak test. Every SOAK_SESSION operations lcd_Begin is
+ *          called again with a new random geometry, and every SOAK_CHECK
+ *          operations DDRAM, CGRAM, the address counter and the driver's
+ *          DDRAM copy are checked against the model. Each SOAK_WINDOW
+ *          operations are timed with soak_Clock(). The first and the last
+ *          1/SOAK_SEGMENT of the windows are added up into early_ops_s and
+ *          late_ops_s, and slowdown is how far late falls below early.
+ *          The windows are also timed with SOAK_CPU_CLOCK. The fastest
+ *          window of each segment gives cpu_early_ops_s and cpu_late_ops_s,
+ *          which a burst of other load cannot pull down, and cpu_slowdown;
+ *          cpu_avg_ops_s and cpu_ms are the plain totals.
+ *          bus_load is the share of the driver's own time count spent on
+ *          the bus and sleep_load the share spent asleep (LCD_LOWPOWER).
+ *          energy_nj is stats_Energy() over the whole run, per lcd_Write.
+ *          statsStructure is cleared at every window.
+ *          Not for 40x4 panels.
+ *
+ * @param   result   - Receives the results.
+ *          ops      - Number of operations, at least 2 * SOAK_WINDOW.
+ *          seed     - Random seed, the same seed gives the same workload.
+ *          max_rows - Largest row count to try (1-4).
+ *          max_cols - Largest column count to try (8-20).
+ *
+ * @return  None.
+ */
+void soak_Run(soakTypeDef *result, uint32_t ops, uint32_t seed, uint8_t max_rows, uint8_t max_cols)
+{
+    memset(result, 0, sizeof(soakTypeDef));
+    result->min_ops_s = 0xFFFFFFFF;
+
+    max_rows = (max_rows < 1) ? 1 : (max_rows > 4) ? 4 : max_rows;
+    max_cols = (max_cols < 8) ? 8 : (max_cols > 20) ? 20 : max_cols;
+    soak_seed = seed ? seed : 1;
+    total_us = 0;
+    total_cpu_us = 0;
+    total_lcd_us = 0;
+    total_bus_us = 0;
+    total_sleep_us = 0;
+    total_nj = 0;
+    total_lcd_ops = 0;
+
+    uint32_t windows = ops / SOAK_WINDOW;
+    uint32_t segment = (windows / SOAK_SEGMENT) ? windows / SOAK_SEGMENT : 1;
+    uint32_t window = 0;
+    uint32_t count = 0;
+    uint64_t early_us = 0;
+    uint64_t late_us = 0;
+    uint32_t cpu_early_us = 0xFFFFFFFF;
+    uint32_t cpu_late_us = 0xFFFFFFFF;
+
+    soak_Session(max_rows, max_cols);
+    stats_Reset();
+    window_start = soak_Clock();
+    window_cpu = SOAK_CPU_CLOCK();
+
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        if (i && i % SOAK_SESSION == 0)
+        {
+            result->errors += soak_Check();
+            result->checks++;
+            soak_Session(max_rows, max_cols);
+            result->sessions++;
+        }
+
+        soak_Op();
+
+        if ((i + 1) % SOAK_CHECK == 0)
+        {
+            result->errors += soak_Check();
+            result->checks++;
+        }
+
+        if (++window == SOAK_WINDOW)
+        {
+            uint32_t cpu_us;
+            uint32_t us = soak_Window(&cpu_us);
+            uint32_t ops_s = us ? (uint32_t)((uint64_t)SOAK_WINDOW * 1000000 / us) : 0;
+
+            if (count < segment)
+            {
+                early_us += us;
+                if (cpu_us < cpu_early_us)
+                {
+                    cpu_early_us = cpu_us;
+                }
+            }
+            if (count >= windows - segment)
+            {
+                late_us += us;
+                if (cpu_us < cpu_late_us)
+                {
+                    cpu_late_us = cpu_us;
+                }
+            }
+            if (ops_s < result->min_ops_s)
+            {
+                result->min_ops_s = ops_s;
+            }
+            count++;
+            window = 0;
+        }
+    }
+
+    result->errors += soak_Check();
+    result->checks++;
+    result->sessions++;
+    result->ops = ops;
+    soak_Window(NULL);
+
+    if (total_us)
+    {
+        result->avg_ops_s = (uint32_t)((uint64_t)ops * 1000000 / total_us);
+    }
+    if (total_cpu_us)
+    {
+        result->cpu_avg_ops_s = (uint32_t)((uint64_t)ops * 1000000 / total_cpu_us);
+        result->cpu_ms = (uint32_t)(total_cpu_us / 1000);
+    }
+    if (total_lcd_us)
+    {
+        result->bus_load = (uint8_t)(total_bus_us * 100 / total_lcd_us);
+        result->sleep_load = (uint8_t)(total_sleep_us * 100 / total_lcd_us);
+    }
+    if (total_lcd_ops)
+    {
+        result->energy_nj = (uint32_t)(total_nj / total_lcd_ops);
+    }
+    if (early_us && late_us)
+    {
+        result->early_ops_s = (uint32_t)((uint64_t)segment * SOAK_WINDOW * 1000000 / early_us);
+        result->late_ops_s = (uint32_t)((uint64_t)segment * SOAK_WINDOW * 1000000 / late_us);
+    }
+    if (result->min_ops_s == 0xFFFFFFFF)
+    {
+        result->min_ops_s = 0;
+    }
+    if (result->early_ops_s > result->late_ops_s)
+    {
+        result->slowdown = (uint8_t)((uint64_t)(result->early_ops_s - result->late_ops_s) * 100
+                                     / result->early_ops_s);
+    }
+    if (cpu_early_us && cpu_late_us && cpu_early_us != 0xFFFFFFFF)
+    {
+        result->cpu_early_ops_s = (uint32_t)((uint64_t)SOAK_WINDOW * 1000000 / cpu_early_us);
+        result->cpu_late_ops_s = (uint32_t)((uint64_t)SOAK_WINDOW * 1000000 / cpu_late_us);
+    }
+    if (result->cpu_early_ops_s > result->cpu_late_ops_s)
+    {
+        result->cpu_slowdown = (uint8_t)((uint64_t)(result->cpu_early_ops_s - result->cpu_late_ops_s) * 100
+                                         / result->cpu_early_ops_s);
+    }
+}
+
+/*********************************************************************
+ * @fn      soak_Rand
+ *
+ * @brief   xorshift32 random number generator.
+ *
+ * @param   None.
+ *
+ * @return  Next random number.
+ */
+static uint32_t soak_Rand(void)
+{
+    soak_seed ^= soak_seed << 13;
+    soak_seed ^= soak_seed >> 17;
+    soak_seed ^= soak_seed << 5;
+    return soak_seed;
+}
+
+/*********************************************************************
+ * @fn      soak_Addr
+ *
+ * @brief   DDRAM address of the first column of a row, as the HD44780
+ *          datasheet lays out 1 to 4 line modules. Kept apart from the
+ *          driver's row_Addr on purpose.
+ *
+ * @param   row - Row number (0-based).
+ *
+ * @return  DDRAM address.
+ */
+static uint8_t soak_Addr(uint8_t row)
+{
+    static const uint8_t base[4] = { 0x00, 0x40, 0x00, 0x40 };
+
+    return base[row] + ((row >= 2) ? cols : 0);
+}
+
+/*********************************************************************
+ * @fn      soak_Session
+ *
+ * @brief   Starts the panel over with a random geometry and resets the model
+ *          to a blank screen with the cursor home.
+ *
+ * @param   max_rows - Largest row count.
+ *          max_cols - Largest column count.
+ *
+ * @return  None.
+ */
+static void soak_Session(uint8_t max_rows, uint8_t max_cols)
+{
+    rows = 1 + soak_Rand() % max_rows;
+    cols = 8 + soak_Rand() % (max_cols - 7);
+
+    lcd_Begin(rows, cols);
+
+    memset(m_ddram, ' ', sizeof(m_ddram));
+    m_row = 0;
+    m_col = 0;
+    m_ac = 0x00;
+#if LCD_USE_CGRAM
+    m_cg_used = 0;
+#endif
+}
+
+/*********************************************************************
+ * @fn      soak_Op
+ *
+ * @brief   Runs one random operation on the panel and the model. Text makes
+ *          up about half of the mix; clear, which takes 2 ms on the panel,
+ *          1 in 32.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+static void soak_Op(void)
+{
+    uint8_t op = soak_Rand() % 32;
+
+    if (op < 16)
+    {
+        soak_Text();
+    }
+    else if (op < 24)
+    {
+        uint8_t row = soak_Rand() % (rows + 1);
+        uint8_t col = soak_Rand() % (cols + 1);
+
+        set_Cursor(row, col);
+        if (row < rows && col < cols)
+        {
+            m_row = row;
+            m_col = col;
+        }
+        else
+        {
+            m_row = 0;
+            m_col = 0;
+        }
+        m_ac = soak_Addr(m_row) + m_col;
+    }
+    else if (op < 25)
+    {
+        clear();
+        memset(m_ddram, ' ', sizeof(m_ddram));
+        m_row = 0;
+        m_col = 0;
+        m_ac = 0x00;
+    }
+#if LCD_USE_CGRAM
+    else if (op < 27)
+    {
+        uint8_t location = soak_Rand() % 8;
+        uint8_t charmap[8];
+
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            charmap[i] = (uint8_t)soak_Rand();
+            m_cgram[location * 8 + i] = charmap[i] & 0x1F;
+        }
+        custom_Char(location, charmap);
+        m_cg_used |= 1 << location;
+        m_row = 0;
+        m_col = 0;
+        m_ac = 0x00;
+    }
+#endif
+    else if (op < 30)
+    {
+        switch (soak_Rand() % 6)
+        {
+            case 0: display_On(); break;
+            case 1: display_Off(); break;
+#if LCD_USE_CURSOR
+            case 2: cursor_On(); break;
+            case 3: cursor_Off(); break;
+            case 4: blink_On(); break;
+            case 5: blink_Off(); break;
+#endif
+            default: break;
+        }
+    }
+    else
+    {
+#if LCD_USE_BACKLIGHT
+        if (soak_Rand() & 1)
+        {
+            bclight_On();
+        }
+        else
+        {
+            bclight_Off();
+        }
+#endif
+    }
+}
+
+/*********************************************************************
+ * @fn      soak_Text
+ *
+ * @brief   Writes a random printable string of up to two rows with convert()
+ *          and follows it in the model, wrapping at the end of each row and
+ *          from the last row to the first.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+static void soak_Text(void)
+{
+    char text[41];
+    uint8_t len = 1 + soak_Rand() % (2 * cols);
+
+    for (uint8_t i = 0; i < len; i++)
+    {
+        text[i] = ' ' + soak_Rand() % 95;
+    }
+    text[len] = '\0';
+
+    convert(text);
+
+    for (uint8_t i = 0; i < len; i++)
+    {
+        if (m_col >= cols)
+        {
+            m_row = (m_row + 1 < rows) ? m_row + 1 : 0;
+            m_col = 0;
+            m_ac = soak_Addr(m_row);
+        }
+        m_ddram[m_ac] = (uint8_t)text[i];
+        m_ac = (m_ac == 0x27) ? 0x40 : (m_ac == 0x67) ? 0x00 : m_ac + 1;
+        m_col++;
+    }
+}
+
+/*********************************************************************
+ * @fn      soak_Check
+ *
+ * @brief   Reads the address counter, all 80 DDRAM cells and the custom
+ *          characters written this session back from the panel and compares
+ *          them, and the driver's DDRAM copy, with the model. After a
+ *          mismatch the panel is cleared so one fault is counted once.
+ *          Returns with the cursor home.
+ *
+ * @param   None.
+ *
+ * @return  Number of mismatching bytes.
+ */
+static uint32_t soak_Check(void)
+{
+    uint8_t buf[40];
+    uint32_t errors = 0;
+
+    if (lcd_ReadAddress() != m_ac)
+    {
+        errors++;
+    }
+
+    for (uint8_t line = 0; line < 2; line++)
+    {
+        lcd_ReadData(LCD_DDRAM | (line * 0x40), buf, 40);
+        for (uint8_t i = 0; i < 40; i++)
+        {
+            if (buf[i] != m_ddram[line * 0x40 + i])
+            {
+                errors++;
+            }
+        }
+    }
+
+#if LCD_USE_SHADOW
+    for (uint8_t row = 0; row < rows; row++)
+    {
+        for (uint8_t col = 0; col < cols; col++)
+        {
+            if (lcd_Cached(row, col) != m_ddram[soak_Addr(row) + col])
+            {
+                errors++;
+            }
+        }
+    }
+#endif
+
+#if LCD_USE_CGRAM
+    for (uint8_t location = 0; location < 8; location++)
+    {
+        if (!(m_cg_used & (1 << location)))
+        {
+            continue;
+        }
+
+        lcd_ReadData(LCD_CGRAM | (location << 3), buf, 8);
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            if ((buf[i] & 0x1F) != m_cgram[location * 8 + i])
+            {
+                errors++;
+            }
+        }
+    }
+#endif
+
+    if (errors)
+    {
+        clear();
+        memset(m_ddram, ' ', sizeof(m_ddram));
+    }
+    else
+    {
+        home();
+    }
+    m_row = 0;
+    m_col = 0;
+    m_ac = 0x00;
+
+    return errors;
+}
+
+/*********************************************************************
+ * @fn      soak_Window
+ *
+ * @brief   Closes a throughput window: reads both clocks, adds the times,
+ *          and the LCD and bus time counted in statsStructure, to the run
+ *          totals and clears statsStructure.
+ *
+ * @param   cpu_us - Receives the CPU time of the window, may be NULL.
+ *
+ * @return  Microseconds the window took on soak_Clock().
+ */
+static uint32_t soak_Window(uint32_t *cpu_us)
+{
+    uint32_t now = soak_Clock();
+    uint32_t cpu = SOAK_CPU_CLOCK();
+    uint32_t us = now - window_start;
+
+    if (cpu_us)
+    {
+        *cpu_us = cpu - window_cpu;
+    }
+    total_cpu_us += cpu - window_cpu;
+    window_start = now;
+    window_cpu = cpu;
+    total_us += us;
+    total_lcd_us += statsStructure.spin_us + statsStructure.sleep_us;
+    total_bus_us += statsStructure.bus_us;
+    total_sleep_us += statsStructure.sleep_us;
+    total_nj += (uint64_t)stats_Energy() * statsStructure.ops;
+    total_lcd_ops += statsStructure.ops;
+    stats_Reset();
+
+    return us;
+}
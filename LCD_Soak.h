@@ -0,0 +1,83 @@
+/********************************** (C) COPYRIGHT  *******************************
+ * File Name          : LCD_Soak.h
+ * Author             : Hiranya Keshan
+ * Version            : V1.0.0
+ * Date               : 2024/10/08
+ * Description        : This file contains all the function prototypes for the
+ *                      soak test of the I2C LCD library.
+ *                      LCD_Soak.h in Project -> Peripheral -> inc
+ *********************************************************************************/
+
+#ifndef INC_LCD_SOAK_H_
+#define INC_LCD_SOAK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <I2C_LCD.h>
+
+#if !LCD_USE_READ || !LCD_USE_STATS
+#error "LCD_Soak needs LCD_USE_READ and LCD_USE_STATS"
+#endif
+
+/* Operations per throughput window and between two readback checks. */
+#ifndef SOAK_WINDOW
+#define SOAK_WINDOW                 1000
+#endif
+#ifndef SOAK_CHECK
+#define SOAK_CHECK                  256
+#endif
+
+/* Operations before a new session with a new random geometry starts. */
+#ifndef SOAK_SESSION
+#define SOAK_SESSION                2000
+#endif
+
+/* The first and last 1/SOAK_SEGMENT of the windows are compared. */
+#ifndef SOAK_SEGMENT
+#define SOAK_SEGMENT                8
+#endif
+
+typedef struct
+{
+    uint32_t ops;
+    uint32_t sessions;
+    uint32_t checks;
+    uint32_t errors;
+
+    uint32_t early_ops_s;
+    uint32_t late_ops_s;
+    uint32_t min_ops_s;
+    uint32_t avg_ops_s;
+    uint8_t  slowdown;
+    uint8_t  bus_load;
+    uint8_t  sleep_load;
+    uint32_t energy_nj;
+
+    uint32_t cpu_early_ops_s;
+    uint32_t cpu_late_ops_s;
+    uint32_t cpu_avg_ops_s;
+    uint32_t cpu_ms;
+    uint8_t  cpu_slowdown;
+
+} soakTypeDef;
+
+/* Clock for the CPU time the test itself takes. On the target it is the
+ * same as soak_Clock(); a host build, where soak_Clock() follows the
+ * panel model, points it at the process CPU time. */
+#ifndef SOAK_CPU_CLOCK
+#define SOAK_CPU_CLOCK              soak_Clock
+#endif
+
+/* Free-running microsecond clocks, provided by the application. */
+uint32_t soak_Clock(void);
+uint32_t SOAK_CPU_CLOCK(void);
+
+void soak_Run(soakTypeDef *result, uint32_t ops, uint32_t seed, uint8_t max_rows, uint8_t max_cols);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_LCD_SOAK_H_ */
@@ -0,0 +1,441 @@
+/********************************** (C) COPYRIGHT  *******************************
+ * File Name          : LCD_Widget.c
+ * Author             : Hiranya Keshan
+ * Version            : V1.0.0
+ * Date               : 2024/10/08
+ * Description        : This file provides the retained mode widget layer.
+ *                      Each widget owns a rectangle of the rows x cols grid
+ *                      set by lcd_Begin and marks itself dirty on change.
+ *                      screen_Update() redraws dirty widgets only and sends
+ *                      only the cells that differ from what the panel shows.
+ *                      LCD_Widget.c in Project -> Peripheral -> src
+ *********************************************************************************/
+
+#include <LCD_Widget.h>
+#include <string.h>
+
+static void widget_Place(widgetTypeDef *w, uint8_t type, uint8_t row, uint8_t col,
+                         uint8_t width, uint8_t height);
+static void widget_Render(widgetTypeDef *w, uint8_t line, char *buf);
+
+/*********************************************************************
+ * @fn      label_Init
+ *
+ * @brief   Sets up a single row text label. Text longer than the label is
+ *          clipped, shorter text is padded with blanks.
+ *
+ * @param   w     - Widget to set up.
+ *          row   - Row of the label (0-based).
+ *          col   - First column of the label (0-based).
+ *          width - Label width in columns.
+ *          text  - NUL terminated text. Kept by reference, not copied.
+ *
+ * @return  None.
+ */
+void label_Init(widgetTypeDef *w, uint8_t row, uint8_t col, uint8_t width, const char *text)
+{
+    widget_Place(w, widget_Label, row, col, width, 1);
+    w->u.label.text = text;
+}
+
+/*********************************************************************
+ * @fn      label_Set
+ *
+ * @brief   Changes the label text. Call again after editing the text in
+ *          place, since the label only keeps the pointer.
+ *
+ * @param   w    - Label widget.
+ *          text - NUL terminated text.
+ *
+ * @return  None.
+ */
+void label_Set(widgetTypeDef *w, const char *text)
+{
+    w->u.label.text = text;
+    w->dirty = SET;
+}
+
+/*********************************************************************
+ * @fn      number_Init
+ *
+ * @brief   Sets up a right aligned signed decimal field. Values that do not
+ *          fit the field are shown as '#'.
+ *
+ * @param   w     - Widget to set up.
+ *          row   - Row of the field (0-based).
+ *          col   - First column of the field (0-based).
+ *          width - Field width in columns.
+ *          value - Initial value.
+ *
+ * @return  None.
+ */
+void number_Init(widgetTypeDef *w, uint8_t row, uint8_t col, uint8_t width, int32_t value)
+{
+    widget_Place(w, widget_Number, row, col, width, 1);
+    w->u.number.value = value;
+}
+
+/*********************************************************************
+ * @fn      number_Set
+ *
+ * @brief   Changes the value of a numeric field. Marks it dirty only when the
+ *          value actually changed.
+ *
+ * @param   w     - Number widget.
+ *          value - New value.
+ *
+ * @return  None.
+ */
+void number_Set(widgetTypeDef *w, int32_t value)
+{
+    if (w->u.number.value != value)
+    {
+        w->u.number.value = value;
+        w->dirty = SET;
+    }
+}
+
+/*********************************************************************
+ * @fn      bar_Init
+ *
+ * @brief   Sets up a horizontal progress bar, one cell per width step.
+ *
+ * @param   w     - Widget to set up.
+ *          row   - Row of the bar (0-based).
+ *          col   - First column of the bar (0-based).
+ *          width - Bar width in columns.
+ *          max   - Value that fills the whole bar.
+ *
+ * @return  None.
+ */
+void bar_Init(widgetTypeDef *w, uint8_t row, uint8_t col, uint8_t width, uint16_t max)
+{
+    widget_Place(w, widget_Bar, row, col, width, 1);
+    w->u.bar.value = 0;
+    w->u.bar.max = max ? max : 1;
+}
+
+/*********************************************************************
+ * @fn      bar_Set
+ *
+ * @brief   Changes the bar value. Marks it dirty only when the number of
+ *          filled cells changes.
+ *
+ * @param   w     - Bar widget.
+ *          value - New value, clipped to max.
+ *
+ * @return  None.
+ */
+void bar_Set(widgetTypeDef *w, uint16_t value)
+{
+    if (value > w->u.bar.max)
+    {
+        value = w->u.bar.max;
+    }
+
+    uint32_t before = (uint32_t)w->u.bar.value * w->width / w->u.bar.max;
+    uint32_t after = (uint32_t)value * w->width / w->u.bar.max;
+
+    w->u.bar.value = value;
+    if (before != after)
+    {
+        w->dirty = SET;
+    }
+}
+
+/*********************************************************************
+ * @fn      menu_Init
+ *
+ * @brief   Sets up a scrollable menu list. The selected item is marked with
+ *          menu_Mark in the first column, and the list scrolls to keep it
+ *          in view.
+ *
+ * @param   w      - Widget to set up.
+ *          row    - Top row of the menu (0-based).
+ *          col    - First column of the menu (0-based).
+ *          width  - Menu width in columns, including the mark.
+ *          height - Number of visible items.
+ *          items  - Array of NUL terminated item texts.
+ *          count  - Number of items.
+ *
+ * @return  None.
+ */
+void menu_Init(widgetTypeDef *w, uint8_t row, uint8_t col, uint8_t width, uint8_t height,
+               const char * const *items, uint8_t count)
+{
+    widget_Place(w, widget_Menu, row, col, width, height);
+    w->u.menu.items = items;
+    w->u.menu.count = count;
+    w->u.menu.sel = 0;
+    w->u.menu.top = 0;
+}
+
+/*********************************************************************
+ * @fn      menu_Next
+ *
+ * @brief   Moves the selection one item down, scrolling when needed.
+ *
+ * @param   w - Menu widget.
+ *
+ * @return  None.
+ */
+void menu_Next(widgetTypeDef *w)
+{
+    if (w->u.menu.sel + 1 >= w->u.menu.count)
+    {
+        return;
+    }
+
+    w->u.menu.sel++;
+    if (w->u.menu.sel >= w->u.menu.top + w->height)
+    {
+        w->u.menu.top++;
+    }
+    w->dirty = SET;
+}
+
+/*********************************************************************
+ * @fn      menu_Prev
+ *
+ * @brief   Moves the selection one item up, scrolling when needed.
+ *
+ * @param   w - Menu widget.
+ *
+ * @return  None.
+ */
+void menu_Prev(widgetTypeDef *w)
+{
+    if (w->u.menu.sel == 0)
+    {
+        return;
+    }
+
+    w->u.menu.sel--;
+    if (w->u.menu.sel < w->u.menu.top)
+    {
+        w->u.menu.top--;
+    }
+    w->dirty = SET;
+}
+
+/*********************************************************************
+ * @fn      menu_Selected
+ *
+ * @brief   Returns the index of the selected menu item.
+ *
+ * @param   w - Menu widget.
+ *
+ * @return  Selected item index.
+ */
+uint8_t menu_Selected(widgetTypeDef *w)
+{
+    return w->u.menu.sel;
+}
+
+/*********************************************************************
+ * @fn      widget_Invalidate
+ *
+ * @brief   Marks a widget for redraw on the next screen_Update().
+ *
+ * @param   w - Widget.
+ *
+ * @return  None.
+ */
+void widget_Invalidate(widgetTypeDef *w)
+{
+    w->dirty = SET;
+}
+
+/*********************************************************************
+ * @fn      screen_Invalidate
+ *
+ * @brief   Marks every widget of a screen for redraw, e.g. when switching
+ *          to it. Cells that already show the right character are still
+ *          skipped by screen_Update().
+ *
+ * @param   screen - Screen.
+ *
+ * @return  None.
+ */
+void screen_Invalidate(screenTypeDef *screen)
+{
+    for (uint8_t i = 0; i < screen->count; i++)
+    {
+        screen->list[i]->dirty = SET;
+    }
+}
+
+/*********************************************************************
+ * @fn      screen_Update
+ *
+ * @brief   Redraws the dirty widgets of a screen. Each dirty row is rendered
+ *          and compared with the driver's copy of the panel (lcd_Cached),
+ *          and only runs of differing cells are sent, as raw character
+ *          codes.
+ *
+ * @param   screen - Screen.
+ *
+ * @return  None.
+ */
+void screen_Update(screenTypeDef *screen)
+{
+    char buf[40];
+
+    for (uint8_t i = 0; i < screen->count; i++)
+    {
+        widgetTypeDef *w = screen->list[i];
+
+        if (!w->dirty)
+        {
+            continue;
+        }
+        w->dirty = RESET;
+
+        for (uint8_t line = 0; line < w->height; line++)
+        {
+            uint8_t row = w->row + line;
+
+            widget_Render(w, line, buf);
+
+            uint8_t x = 0;
+            while (x < w->width)
+            {
+                if ((uint8_t)buf[x] == lcd_Cached(row, w->col + x))
+                {
+                    x++;
+                    continue;
+                }
+
+                uint8_t start = x;
+                while (x < w->width && (uint8_t)buf[x] != lcd_Cached(row, w->col + x))
+                {
+                    x++;
+                }
+                lcd_Put(row, w->col + start, &buf[start], x - start);
+            }
+        }
+    }
+}
+
+/*********************************************************************
+ * @fn      widget_Place
+ *
+ * @brief   Fills in the common widget fields, limiting the width to the
+ *          40 column render buffer, and marks the widget dirty. Cells
+ *          outside the display are clipped when the widget is drawn.
+ *
+ * @param   w      - Widget.
+ *          type   - widget_Label, widget_Number, widget_Bar or widget_Menu.
+ *          row    - Top row (0-based).
+ *          col    - Left column (0-based).
+ *          width  - Width in columns.
+ *          height - Height in rows.
+ *
+ * @return  None.
+ */
+static void widget_Place(widgetTypeDef *w, uint8_t type, uint8_t row, uint8_t col,
+                         uint8_t width, uint8_t height)
+{
+    if (width > 40)
+    {
+        width = 40;
+    }
+
+    w->type = type;
+    w->row = row;
+    w->col = col;
+    w->width = width;
+    w->height = height;
+    w->dirty = SET;
+}
+
+/*********************************************************************
+ * @fn      widget_Render
+ *
+ * @brief   Renders one row of a widget into a buffer of width characters.
+ *
+ * @param   w    - Widget.
+ *          line - Row within the widget (0-based).
+ *          buf  - Output, at least w->width characters. Not NUL terminated.
+ *
+ * @return  None.
+ */
+static void widget_Render(widgetTypeDef *w, uint8_t line, char *buf)
+{
+    memset(buf, ' ', w->width);
+
+    switch (w->type)
+    {
+        case widget_Label:
+        {
+            const char *text = w->u.label.text;
+            for (uint8_t x = 0; x < w->width && text && text[x]; x++)
+            {
+                buf[x] = text[x];
+            }
+            break;
+        }
+
+        case widget_Number:
+        {
+            int32_t value = w->u.number.value;
+            uint32_t mag = (value < 0) ? -(uint32_t)value : (uint32_t)value;
+            int8_t x = w->width - 1;
+
+            do
+            {
+                if (x < 0)
+                {
+                    break;
+                }
+                buf[x--] = '0' + mag % 10;
+                mag /= 10;
+            } while (mag);
+
+            if (value < 0 && x >= 0)
+            {
+                buf[x--] = '-';
+            }
+            else if (value < 0)
+            {
+                mag = 1;
+            }
+
+            if (mag)
+            {
+                memset(buf, '#', w->width);
+            }
+            break;
+        }
+
+        case widget_Bar:
+        {
+            uint32_t fill = (uint32_t)w->u.bar.value * w->width / w->u.bar.max;
+            memset(buf, bar_Full, fill);
+            break;
+        }
+
+        case widget_Menu:
+        {
+            uint8_t item = w->u.menu.top + line;
+            if (item >= w->u.menu.count)
+            {
+                break;
+            }
+            if (item == w->u.menu.sel)
+            {
+                buf[0] = menu_Mark;
+            }
+
+            const char *text = w->u.menu.items[item];
+            for (uint8_t x = 1; x < w->width && text[x - 1]; x++)
+            {
+                buf[x] = text[x - 1];
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
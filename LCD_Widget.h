@@ -0,0 +1,96 @@
+/********************************** (C) COPYRIGHT  *******************************
+ * File Name          : LCD_Widget.h
+ * Author             : Hiranya Keshan
+ * Version            : V1.0.0
+ * Date               : 2024/10/08
+ * Description        : This file contains all the function prototypes for the
+ *                      retained mode widget layer on top of the I2C LCD library.
+ *                      LCD_Widget.h in Project -> Peripheral -> inc
+ *********************************************************************************/
+
+#ifndef INC_LCD_WIDGET_H_
+#define INC_LCD_WIDGET_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <I2C_LCD.h>
+
+#if !LCD_USE_SHADOW
+#error "LCD_Widget needs LCD_USE_SHADOW"
+#endif
+
+#define widget_Label                ((uint8_t)0x00)
+#define widget_Number               ((uint8_t)0x01)
+#define widget_Bar                  ((uint8_t)0x02)
+#define widget_Menu                 ((uint8_t)0x03)
+
+#define bar_Full                    ((uint8_t)0xFF)
+#define menu_Mark                   ((uint8_t)'>')
+
+typedef struct
+{
+    uint8_t type;
+    uint8_t row;
+    uint8_t col;
+    uint8_t width;
+    uint8_t height;
+    uint8_t dirty;
+
+    union
+    {
+        struct
+        {
+            const char *text;
+        } label;
+
+        struct
+        {
+            int32_t value;
+        } number;
+
+        struct
+        {
+            uint16_t value;
+            uint16_t max;
+        } bar;
+
+        struct
+        {
+            const char * const *items;
+            uint8_t count;
+            uint8_t sel;
+            uint8_t top;
+        } menu;
+    } u;
+
+} widgetTypeDef;
+
+typedef struct
+{
+    widgetTypeDef **list;
+    uint8_t count;
+
+} screenTypeDef;
+
+void label_Init(widgetTypeDef *w, uint8_t row, uint8_t col, uint8_t width, const char *text);
+void label_Set(widgetTypeDef *w, const char *text);
+void number_Init(widgetTypeDef *w, uint8_t row, uint8_t col, uint8_t width, int32_t value);
+void number_Set(widgetTypeDef *w, int32_t value);
+void bar_Init(widgetTypeDef *w, uint8_t row, uint8_t col, uint8_t width, uint16_t max);
+void bar_Set(widgetTypeDef *w, uint16_t value);
+void menu_Init(widgetTypeDef *w, uint8_t row, uint8_t col, uint8_t width, uint8_t height,
+               const char * const *items, uint8_t count);
+void menu_Next(widgetTypeDef *w);
+void menu_Prev(widgetTypeDef *w);
+uint8_t menu_Selected(widgetTypeDef *w);
+void widget_Invalidate(widgetTypeDef *w);
+void screen_Invalidate(screenTypeDef *screen);
+void screen_Update(screenTypeDef *screen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_LCD_WIDGET_H_ */
@@ -20,21 +20,60 @@
 
 #include "debug.h"
 #include "I2C_LCD.h"                //Or you can include <I2C_LCD.h> in ch32c00x_conf.h
+#if LCD_USE_SHADOW
+#include "LCD_Widget.h"
+#endif
+#ifdef RUN_SOAK
+#include "LCD_Soak.h"                //Build with -DRUN_SOAK=<operations> to run the soak test first
+#include <ch32v00x_tim.h>
+#include <ch32v00x_misc.h>
+
+static volatile uint16_t soak_high;
+
+static void soak_ClockBegin(void);
+void TIM1_UP_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+#endif
 
 int main(void)
 {
     SystemCoreClockUpdate();
     Delay_Init();
+    USART_Printf_Init(115200);
 
     i2c_Begin(400000 , TxAdderss);   //Bound < 400kHz ; Default address -> 0x4E
     lcd_Begin(2 , 16);               //Row count ; Column count
+#if LCD_USE_PWM
+    bclight_PwmBegin(100);           //Backlight dimming, PWM frequency in Hz
+#endif
+
+#ifdef RUN_SOAK
+    soakTypeDef soak;
+    soak_ClockBegin();
+    soak_Run(&soak, RUN_SOAK, 1, 4, 20);   //Operations ; Seed ; Up to 4 rows ; Up to 20 columns
+    printf("soak %lu ops, %lu sessions, %lu checks, %lu errors\r\n",
+           soak.ops, soak.sessions, soak.checks, soak.errors);
+    printf("ops/s early %lu, late %lu, min %lu, avg %lu, slowdown %u%%, bus %u%%\r\n",
+           soak.early_ops_s, soak.late_ops_s, soak.min_ops_s, soak.avg_ops_s,
+           soak.slowdown, soak.bus_load);
+    printf("energy %lu nJ/op, asleep %u%%\r\n", soak.energy_nj, soak.sleep_load);
+    lcd_Begin(2 , 16);
+#endif
     display_Off();
     clear();
 
+#if LCD_USE_SHADOW
+    widgetTypeDef count;
+    widgetTypeDef *countdown_list[] = { &count };
+    screenTypeDef countdown = { countdown_list, 1 };
+    number_Init(&count, 1, 7, 2, 5);
+#endif
+
     while(1){
         clear();
         display_On();
+#if LCD_USE_BACKLIGHT
         bclight_On();
+#endif
         set_Cursor(0, 0);
         convert("1602 LCD Demo by");
         set_Cursor(1,1);
@@ -64,6 +103,7 @@ int main(void)
         clear();
 
         set_Cursor(0, 1);
+#if LCD_USE_BACKLIGHT
         convert("Want to blink?");
         Delay_Ms(2000);
         for (int i = 0; i < 10; ++i) {
@@ -74,29 +114,131 @@ int main(void)
         }
         Delay_Ms(500);
         clear();
+#endif
+
+#if LCD_USE_PWM
+        set_Cursor(0, 3);
+        convert("Or to fade?");
+        Delay_Ms(1000);
+        bclight_Fade(0, 6);
+        Delay_Ms(1500);
+        bclight_Fade(BCLIGHT_PWM_LEVELS, 6);
+        Delay_Ms(1500);
+        clear();
+#endif
 
         set_Cursor(0, 1);
         convert("Display off in");
         Delay_Ms(1000);
-        set_Cursor(1, 7);
-        convert("05");
-        Delay_Ms(1000);
-        set_Cursor(1, 7);
-        convert("04");
-        Delay_Ms(1000);
-        set_Cursor(1, 7);
-        convert("03");
-        Delay_Ms(1000);
-        set_Cursor(1, 7);
-        convert("02");
-        Delay_Ms(1000);
-        set_Cursor(1, 7);
-        convert("01");
-        Delay_Ms(1000);
+#if LCD_USE_SHADOW
+        screen_Invalidate(&countdown);
+        for (int i = 5; i > 0; --i) {
+            number_Set(&count, i);
+            screen_Update(&countdown);
+            Delay_Ms(1000);
+        }
+#else
+        for (int i = 5; i > 0; --i) {
+            char digit[2] = { '0' + i, '\0' };
+            set_Cursor(1, 8);
+            convert(digit);
+            Delay_Ms(1000);
+        }
+#endif
 
         display_Off();
         Delay_Ms(1000);
+#if LCD_USE_BACKLIGHT
         bclight_Off();
+#endif
+
+#if LCD_USE_STATS
+        printf("ops %lu, bus %lu B, spin %lu us, sleep %lu us, %lu nJ/op\r\n",
+               statsStructure.ops, statsStructure.bus_bytes, statsStructure.spin_us,
+               statsStructure.sleep_us, stats_Energy());
+        stats_Reset();
+#endif
         Delay_Ms(5000);
     }
 }
+
+#ifdef RUN_SOAK
+/*********************************************************************
+ * @fn      soak_ClockBegin
+ *
+ * @brief   Starts TIM1 counting microseconds for soak_Clock(). The update
+ *          interrupt counts the upper 16 bits.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+static void soak_ClockBegin(void)
+{
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStructure={0};
+    NVIC_InitTypeDef NVIC_InitStructure={0};
+
+    RCC_APB2PeriphClockCmd( RCC_APB2Periph_TIM1, ENABLE );
+
+    TIM_TimeBaseInitStructure.TIM_Prescaler = SystemCoreClock / 1000000 - 1;
+    TIM_TimeBaseInitStructure.TIM_Period = 0xFFFF;
+    TIM_TimeBaseInitStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+    TIM_TimeBaseInitStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInit( TIM1, &TIM_TimeBaseInitStructure );
+    TIM_ClearITPendingBit( TIM1, TIM_IT_Update );
+    TIM_ITConfig( TIM1, TIM_IT_Update, ENABLE );
+
+    NVIC_InitStructure.NVIC_IRQChannel = TIM1_UP_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init( &NVIC_InitStructure );
+
+    TIM_Cmd( TIM1, ENABLE );
+}
+
+/*********************************************************************
+ * @fn      soak_Clock
+ *
+ * @brief   Microseconds since soak_ClockBegin(), for LCD_Soak. A wrap the
+ *          interrupt has not counted yet is taken from the update flag.
+ *
+ * @param   None.
+ *
+ * @return  Free-running microsecond count.
+ */
+uint32_t soak_Clock(void)
+{
+    uint16_t high;
+    uint16_t low;
+
+    __disable_irq();
+    high = soak_high;
+    low = TIM1->CNT;
+    if (TIM_GetFlagStatus( TIM1, TIM_FLAG_Update ) != RESET && low < 0x8000)
+    {
+        high++;
+    }
+    __enable_irq();
+
+    return ((uint32_t)high << 16) | low;
+}
+
+/*********************************************************************
+ * @fn      TIM1_UP_IRQHandler
+ *
+ * @brief   Counts TIM1 wraps for soak_Clock().
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+void TIM1_UP_IRQHandler(void)
+{
+    if (TIM_GetITStatus( TIM1, TIM_IT_Update ) != RESET)
+    {
+        TIM_ClearITPendingBit( TIM1, TIM_IT_Update );
+        soak_high++;
+    }
+}
+#endif
@@ -0,0 +1,153 @@
+/********************************** (C) COPYRIGHT  *******************************
+ * File Name          : bench_host.c
+ * Author             : Hiranya Keshan
+ * Version            : V1.0.0
+ * Date               : 2024/10/08
+ * Description        : Times a clear and full redraw of a 40x4 panel on the
+ *                      PCF8574/HD44780 model, in model time at 400kHz:
+ *                      - both controllers, lcd_Block() alternating between
+ *                        them,
+ *                      - both controllers, lcd_Block() on one controller's
+ *                        rows and then on the other's,
+ *                      - two passes of clear and an 80 character redraw on
+ *                        a single controller, i.e. the controllers fed
+ *                        one after the other.
+ *                      The panel contents and busy violations are checked,
+ *                      and stats_Energy() gives the MCU energy per write.
+ *
+ *                      Usage: lcd_bench
+ *********************************************************************************/
+
+#include <I2C_LCD.h>
+#include "lcd_model.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_BOUND                 400000
+
+static char text[160];
+static uint32_t failures;
+
+/*********************************************************************
+ * @fn      bench_Check
+ *
+ * @brief   Compares a controller's DDRAM rows with the text.
+ *
+ * @param   ctrl  - Controller (0 or 1).
+ *          first - Index in text of its first row.
+ *          rows  - Number of 40 character rows.
+ *
+ * @return  None.
+ */
+static void bench_Check(uint8_t ctrl, uint16_t first, uint8_t rows)
+{
+    for (uint8_t row = 0; row < rows; row++)
+    {
+        if (memcmp(&modelStructure.lcd[ctrl].ddram[row * 0x40], &text[first + row * 40], 40))
+        {
+            failures++;
+        }
+    }
+}
+
+/*********************************************************************
+ * @fn      bench_Start
+ *
+ * @brief   Powers the model up and initialises the panel.
+ *
+ * @param   controllers - Controllers on the model.
+ *          rows        - Row count for lcd_Begin.
+ *
+ * @return  Model time before the measured redraw, in ns.
+ */
+static uint64_t bench_Start(uint8_t controllers, uint8_t rows)
+{
+    model_Begin(controllers);
+    i2c_Begin(BENCH_BOUND , TxAdderss);
+    if (!lcd_Begin(rows , 40))
+    {
+        failures++;
+    }
+    stats_Reset();
+
+    return modelStructure.now_ns;
+}
+
+/*********************************************************************
+ * @fn      bench_Report
+ *
+ * @brief   Prints the time, bus share and energy per write of one redraw
+ *          and counts busy violations as failures.
+ *
+ * @param   name  - Label.
+ *          ns    - Redraw time.
+ *          bus   - Bus time of the redraw.
+ *
+ * @return  Redraw time in microseconds.
+ */
+static uint32_t bench_Report(const char *name, uint64_t ns, uint64_t bus)
+{
+    printf("%-34s %7.2f ms, bus %5.1f%%, %4lu nJ/op\n", name, ns / 1e6, 100.0 * bus / ns,
+           (unsigned long)stats_Energy());
+    failures += modelStructure.violations + modelStructure.bus_errors;
+
+    return (uint32_t)(ns / 1000);
+}
+
+int main(void)
+{
+    uint64_t start;
+    uint64_t bus;
+    uint32_t block_us;
+    uint32_t split_us;
+    uint32_t serial_us;
+
+    for (uint16_t i = 0; i < sizeof(text); i++)
+    {
+        text[i] = '!' + (i * 7) % 94;
+    }
+
+    /* 40x4, lcd_Block alternating between the controllers */
+    start = bench_Start(2, 4);
+    bus = modelStructure.bus_ns;
+    clear();
+    lcd_Block(0, 0, 40, 4, text, sizeof(text));
+    block_us = bench_Report("40x4 lcd_Block, interleaved", modelStructure.now_ns - start,
+                            modelStructure.bus_ns - bus);
+    bench_Check(0, 0, 2);
+    bench_Check(1, 80, 2);
+
+    /* 40x4, one controller's rows after the other's */
+    start = bench_Start(2, 4);
+    bus = modelStructure.bus_ns;
+    clear();
+    lcd_Block(0, 0, 40, 2, text, 80);
+    lcd_Block(2, 0, 40, 2, &text[80], 80);
+    split_us = bench_Report("40x4 lcd_Block, one then the other", modelStructure.now_ns - start,
+                            modelStructure.bus_ns - bus);
+    bench_Check(0, 0, 2);
+    bench_Check(1, 80, 2);
+
+    /* Two 40x2 passes, one controller after the other */
+    start = bench_Start(1, 2);
+    bus = modelStructure.bus_ns;
+    for (uint8_t pass = 0; pass < 2; pass++)
+    {
+        clear();
+        lcd_Block(0, 0, 40, 2, &text[pass * 80], 80);
+        bench_Check(0, pass * 80, 2);
+    }
+    serial_us = bench_Report("2 x 40x2, controllers serialized", modelStructure.now_ns - start,
+                             modelStructure.bus_ns - bus);
+
+    printf("interleaved/serialized %.2f, one then the other/serialized %.2f\n",
+           (double)block_us / serial_us, (double)split_us / serial_us);
+
+    if (failures)
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
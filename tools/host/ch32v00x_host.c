@@ -0,0 +1,268 @@
+/********************************** (C) COPYRIGHT  *******************************
+ * File Name          : ch32v00x_host.c
+ * Author             : Hiranya Keshan
+ * Version            : V1.0.0
+ * Date               : 2024/10/08
+ * Description        : This file provides the CH32V00x firmware library calls
+ *                      the I2C LCD library makes, for a host build. The I2C
+ *                      master follows the bus protocol and hands each data
+ *                      byte to the PCF8574 model; events out of order and
+ *                      transfers to the wrong address count as bus errors.
+ *                      Every START and STOP takes one SCL period and every
+ *                      byte nine, and the delays only advance the model's
+ *                      clock. Built with LCD_LOWPOWER, interrupts read as
+ *                      enabled so the library sleeps, and WFI moves the
+ *                      model's clock on to the SysTick compare and runs
+ *                      SysTick_Handler; otherwise they read as off.
+ *********************************************************************************/
+
+#include <ch32v00x.h>
+#include <ch32v00x_i2c.h>
+#include <ch32v00x_rcc.h>
+#include <ch32v00x_tim.h>
+#include <ch32v00x_misc.h>
+#include <I2C_LCD.h>
+#include "lcd_model.h"
+
+/* I2C master state */
+#define BUS_IDLE                    0
+#define BUS_START                   1
+#define BUS_TRANSMIT                2
+#define BUS_RECEIVE                 3
+
+static SysTick_Type systick;
+static GPIO_TypeDef gpioc;
+static I2C_TypeDef i2c1;
+static TIM_TypeDef tim2;
+
+SysTick_Type *SysTick = &systick;
+GPIO_TypeDef *GPIOC = &gpioc;
+I2C_TypeDef *I2C1 = &i2c1;
+TIM_TypeDef *TIM2 = &tim2;
+
+uint32_t SystemCoreClock = 48000000;
+
+static uint32_t bus_bound = 100000;
+static uint8_t bus_state = BUS_IDLE;
+static uint8_t bus_rx;
+static uint8_t bus_rx_full;
+
+static void bus_Expect(uint8_t ok);
+#if LCD_LOWPOWER && LCD_LOWPOWER_IRQ
+void SysTick_Handler(void);
+#endif
+
+void Delay_Us(uint32_t n)
+{
+    model_Wait((uint64_t)n * 1000);
+}
+
+void Delay_Ms(uint32_t n)
+{
+    model_Wait((uint64_t)n * 1000000);
+}
+
+void I2C_Init(I2C_TypeDef *I2Cx, I2C_InitTypeDef *I2C_InitStruct)
+{
+    (void)I2Cx;
+    bus_bound = I2C_InitStruct->I2C_ClockSpeed;
+    bus_state = BUS_IDLE;
+}
+
+void I2C_GenerateSTART(I2C_TypeDef *I2Cx, FunctionalState NewState)
+{
+    (void)I2Cx;
+    if (NewState)
+    {
+        model_Clock(1, bus_bound);
+        bus_state = BUS_START;
+    }
+}
+
+void I2C_GenerateSTOP(I2C_TypeDef *I2Cx, FunctionalState NewState)
+{
+    (void)I2Cx;
+    if (NewState)
+    {
+        bus_Expect(bus_state == BUS_TRANSMIT);
+        model_Clock(1, bus_bound);
+        bus_state = BUS_IDLE;
+    }
+}
+
+/*********************************************************************
+ * @fn      I2C_Send7bitAddress
+ *
+ * @brief   Addresses the expander. In receiver mode the one byte that
+ *          follows is clocked in straight away; the library always sets up
+ *          a NACK and a repeated START for it first.
+ *
+ * @param   I2Cx          - I2C1.
+ *          Address       - Address in the upper seven bits.
+ *          I2C_Direction - I2C_Direction_Transmitter or _Receiver.
+ *
+ * @return  None.
+ */
+void I2C_Send7bitAddress(I2C_TypeDef *I2Cx, uint8_t Address, uint8_t I2C_Direction)
+{
+    (void)I2Cx;
+    bus_Expect(bus_state == BUS_START);
+    bus_Expect(Address == TxAdderss);
+    model_Clock(9, bus_bound);
+
+    if (I2C_Direction == I2C_Direction_Receiver)
+    {
+        bus_state = BUS_RECEIVE;
+        model_Clock(9, bus_bound);
+        bus_rx = model_Pins();
+        bus_rx_full = 1;
+    }
+    else
+    {
+        bus_state = BUS_TRANSMIT;
+    }
+}
+
+void I2C_SendData(I2C_TypeDef *I2Cx, uint8_t Data)
+{
+    (void)I2Cx;
+    bus_Expect(bus_state == BUS_TRANSMIT);
+    model_Clock(9, bus_bound);
+    model_Port(Data);
+}
+
+uint8_t I2C_ReceiveData(I2C_TypeDef *I2Cx)
+{
+    (void)I2Cx;
+    bus_Expect(bus_rx_full);
+    bus_rx_full = 0;
+    return bus_rx;
+}
+
+/*********************************************************************
+ * @fn      I2C_CheckEvent
+ *
+ * @brief   Checks the event against the state of the transfer. An event
+ *          that cannot have happened is counted as a bus error and then
+ *          reported anyway, so the library does not hang.
+ *
+ * @param   I2Cx      - I2C1.
+ *          I2C_EVENT - I2C_EVENT_MASTER_xxx.
+ *
+ * @return  READY.
+ */
+ErrorStatus I2C_CheckEvent(I2C_TypeDef *I2Cx, uint32_t I2C_EVENT)
+{
+    (void)I2Cx;
+
+    switch (I2C_EVENT)
+    {
+        case I2C_EVENT_MASTER_MODE_SELECT:
+            bus_Expect(bus_state == BUS_START);
+            break;
+        case I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED:
+        case I2C_EVENT_MASTER_BYTE_TRANSMITTING:
+        case I2C_EVENT_MASTER_BYTE_TRANSMITTED:
+            bus_Expect(bus_state == BUS_TRANSMIT);
+            break;
+        case I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED:
+            bus_Expect(bus_state == BUS_RECEIVE);
+            break;
+        case I2C_EVENT_MASTER_BYTE_RECEIVED:
+            bus_Expect(bus_rx_full);
+            break;
+        default:
+            bus_Expect(0);
+            break;
+    }
+    return READY;
+}
+
+FlagStatus I2C_GetFlagStatus(I2C_TypeDef *I2Cx, uint32_t I2C_FLAG)
+{
+    (void)I2Cx;
+
+    if (I2C_FLAG == I2C_FLAG_BUSY)
+    {
+        return (bus_state != BUS_IDLE) ? SET : RESET;
+    }
+    if (I2C_FLAG == I2C_FLAG_TXE)
+    {
+        return (bus_state == BUS_TRANSMIT) ? SET : RESET;
+    }
+    return RESET;
+}
+
+/*********************************************************************
+ * @fn      bus_Expect
+ *
+ * @brief   Counts a bus error when a protocol check fails.
+ *
+ * @param   ok - Result of the check.
+ *
+ * @return  None.
+ */
+static void bus_Expect(uint8_t ok)
+{
+    if (!ok)
+    {
+        modelStructure.bus_errors++;
+    }
+}
+
+/* Nothing else has an effect on the host */
+void I2C_Cmd(I2C_TypeDef *I2Cx, FunctionalState NewState) { (void)I2Cx; (void)NewState; }
+void I2C_AcknowledgeConfig(I2C_TypeDef *I2Cx, FunctionalState NewState) { (void)I2Cx; (void)NewState; }
+void I2C_ITConfig(I2C_TypeDef *I2Cx, uint16_t I2C_IT, FunctionalState NewState) { (void)I2Cx; (void)I2C_IT; (void)NewState; }
+void GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_InitStruct) { (void)GPIOx; (void)GPIO_InitStruct; }
+void RCC_APB2PeriphClockCmd(uint32_t RCC_APB2Periph, FunctionalState NewState) { (void)RCC_APB2Periph; (void)NewState; }
+void RCC_APB1PeriphClockCmd(uint32_t RCC_APB1Periph, FunctionalState NewState) { (void)RCC_APB1Periph; (void)NewState; }
+void TIM_TimeBaseInit(TIM_TypeDef *TIMx, TIM_TimeBaseInitTypeDef *TIM_TimeBaseInitStruct) { (void)TIMx; (void)TIM_TimeBaseInitStruct; }
+void TIM_ITConfig(TIM_TypeDef *TIMx, uint16_t TIM_IT, FunctionalState NewState) { (void)TIMx; (void)TIM_IT; (void)NewState; }
+void TIM_Cmd(TIM_TypeDef *TIMx, FunctionalState NewState) { (void)TIMx; (void)NewState; }
+ITStatus TIM_GetITStatus(TIM_TypeDef *TIMx, uint16_t TIM_IT) { (void)TIMx; (void)TIM_IT; return RESET; }
+void TIM_ClearITPendingBit(TIM_TypeDef *TIMx, uint16_t TIM_IT) { (void)TIMx; (void)TIM_IT; }
+void NVIC_Init(NVIC_InitTypeDef *NVIC_InitStruct) { (void)NVIC_InitStruct; }
+void NVIC_EnableIRQ(IRQn_Type IRQn) { (void)IRQn; }
+void NVIC_DisableIRQ(IRQn_Type IRQn) { (void)IRQn; }
+void __enable_irq(void) { }
+void __disable_irq(void) { }
+
+#if LCD_LOWPOWER
+/*********************************************************************
+ * @fn      __WFI
+ *
+ * @brief   Sleeps until the SysTick compare, the only wake-up the library
+ *          waits for that the model does not give at once: the SysTick
+ *          counter runs at SystemCoreClock / 8. I2C events are always
+ *          already there.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+void __WFI(void)
+{
+    uint32_t per_us = SystemCoreClock / 8000000;
+
+    if ((SysTick->CTLR & 0x03) != 0x03 || SysTick->CMP < SysTick->CNT)
+    {
+        return;
+    }
+
+    model_Wait((uint64_t)(SysTick->CMP - SysTick->CNT) * 1000 / per_us);
+    SysTick->CNT = SysTick->CMP;
+    SysTick->SR |= 1;
+#if LCD_LOWPOWER_IRQ
+    SysTick_Handler();
+#else
+    lcd_SysTick();
+#endif
+}
+
+/* MIE set: the library takes its sleeping paths */
+uint32_t __get_MSTATUS(void) { return 0x08; }
+#else
+void __WFI(void) { }
+uint32_t __get_MSTATUS(void) { return 0; }
+#endif
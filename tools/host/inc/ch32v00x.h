@@ -0,0 +1,102 @@
+/********************************** (C) COPYRIGHT  *******************************
+ * File Name          : ch32v00x.h
+ * Author             : Hiranya Keshan
+ * Version            : V1.0.0
+ * Date               : 2024/10/08
+ * Description        : Host stand-in for the CH32V00x device header. Only the
+ *                      types, registers and functions the I2C LCD library
+ *                      uses are declared. They are implemented in
+ *                      ch32v00x_host.c on top of the panel model.
+ *********************************************************************************/
+
+#ifndef __CH32V00x_H
+#define __CH32V00x_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* The WCH interrupt attribute means nothing to the host compiler */
+#define interrupt(x)
+
+typedef uint32_t u32;
+typedef uint16_t u16;
+typedef uint8_t  u8;
+
+typedef enum {RESET = 0, SET = !RESET} FlagStatus, ITStatus;
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+typedef enum {NoREADY = 0, READY = !NoREADY} ErrorStatus;
+
+typedef enum
+{
+    SysTicK_IRQn = 12,
+    I2C1_EV_IRQn = 30,
+    TIM2_IRQn = 38,
+} IRQn_Type;
+
+typedef struct
+{
+    volatile uint32_t CTLR;
+    volatile uint32_t SR;
+    volatile uint32_t CNT;
+    uint32_t RESERVED0;
+    volatile uint32_t CMP;
+} SysTick_Type;
+
+typedef struct { uint32_t RESERVED; } GPIO_TypeDef;
+typedef struct { uint32_t RESERVED; } I2C_TypeDef;
+typedef struct { uint32_t RESERVED; } TIM_TypeDef;
+
+extern SysTick_Type *SysTick;
+extern GPIO_TypeDef *GPIOC;
+extern I2C_TypeDef *I2C1;
+extern TIM_TypeDef *TIM2;
+
+extern uint32_t SystemCoreClock;
+
+/* GPIO */
+typedef enum
+{
+    GPIO_Speed_10MHz = 1,
+    GPIO_Speed_2MHz,
+    GPIO_Speed_30MHz
+} GPIOSpeed_TypeDef;
+
+typedef enum
+{
+    GPIO_Mode_AF_OD = 0x1C,
+    GPIO_Mode_AF_PP = 0x18
+} GPIOMode_TypeDef;
+
+typedef struct
+{
+    uint16_t GPIO_Pin;
+    GPIOSpeed_TypeDef GPIO_Speed;
+    GPIOMode_TypeDef GPIO_Mode;
+} GPIO_InitTypeDef;
+
+#define GPIO_Pin_1                  ((uint16_t)0x0002)
+#define GPIO_Pin_2                  ((uint16_t)0x0004)
+
+void GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_InitStruct);
+
+/* Core */
+void __WFI(void);
+void __enable_irq(void);
+void __disable_irq(void);
+uint32_t __get_MSTATUS(void);
+
+void NVIC_EnableIRQ(IRQn_Type IRQn);
+void NVIC_DisableIRQ(IRQn_Type IRQn);
+
+/* Delays, from debug.c on the target */
+void Delay_Us(uint32_t n);
+void Delay_Ms(uint32_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CH32V00x_H */
@@ -0,0 +1,66 @@
+/********************************** (C) COPYRIGHT  *******************************
+ * File Name          : ch32v00x_i2c.h
+ * Author             : Hiranya Keshan
+ * Version            : V1.0.0
+ * Date               : 2024/10/08
+ * Description        : Host stand-in for the I2C firmware library header.
+ *                      Event and flag values are those of the WCH library.
+ *********************************************************************************/
+
+#ifndef __CH32V00x_I2C_H
+#define __CH32V00x_I2C_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ch32v00x.h>
+
+typedef struct
+{
+    uint32_t I2C_ClockSpeed;
+    uint16_t I2C_Mode;
+    uint16_t I2C_DutyCycle;
+    uint16_t I2C_OwnAddress1;
+    uint16_t I2C_Ack;
+    uint16_t I2C_AcknowledgedAddress;
+} I2C_InitTypeDef;
+
+#define I2C_Mode_I2C                                ((uint16_t)0x0000)
+#define I2C_DutyCycle_16_9                          ((uint16_t)0x4000)
+#define I2C_Ack_Enable                              ((uint16_t)0x0400)
+#define I2C_AcknowledgedAddress_7bit                ((uint16_t)0x4000)
+
+#define I2C_Direction_Transmitter                   ((uint8_t)0x00)
+#define I2C_Direction_Receiver                      ((uint8_t)0x01)
+
+#define I2C_IT_BUF                                  ((uint16_t)0x0400)
+#define I2C_IT_EVT                                  ((uint16_t)0x0200)
+
+#define I2C_FLAG_BUSY                               ((uint32_t)0x00020000)
+#define I2C_FLAG_TXE                                ((uint32_t)0x10000080)
+
+#define I2C_EVENT_MASTER_MODE_SELECT                ((uint32_t)0x00030001)
+#define I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED  ((uint32_t)0x00070082)
+#define I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED     ((uint32_t)0x00030002)
+#define I2C_EVENT_MASTER_BYTE_RECEIVED              ((uint32_t)0x00030040)
+#define I2C_EVENT_MASTER_BYTE_TRANSMITTING          ((uint32_t)0x00070080)
+#define I2C_EVENT_MASTER_BYTE_TRANSMITTED           ((uint32_t)0x00070084)
+
+void I2C_Init(I2C_TypeDef *I2Cx, I2C_InitTypeDef *I2C_InitStruct);
+void I2C_Cmd(I2C_TypeDef *I2Cx, FunctionalState NewState);
+void I2C_GenerateSTART(I2C_TypeDef *I2Cx, FunctionalState NewState);
+void I2C_GenerateSTOP(I2C_TypeDef *I2Cx, FunctionalState NewState);
+void I2C_AcknowledgeConfig(I2C_TypeDef *I2Cx, FunctionalState NewState);
+void I2C_ITConfig(I2C_TypeDef *I2Cx, uint16_t I2C_IT, FunctionalState NewState);
+void I2C_SendData(I2C_TypeDef *I2Cx, uint8_t Data);
+uint8_t I2C_ReceiveData(I2C_TypeDef *I2Cx);
+void I2C_Send7bitAddress(I2C_TypeDef *I2Cx, uint8_t Address, uint8_t I2C_Direction);
+ErrorStatus I2C_CheckEvent(I2C_TypeDef *I2Cx, uint32_t I2C_EVENT);
+FlagStatus I2C_GetFlagStatus(I2C_TypeDef *I2Cx, uint32_t I2C_FLAG);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CH32V00x_I2C_H */
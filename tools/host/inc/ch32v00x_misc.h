@@ -0,0 +1,32 @@
+/********************************** (C) COPYRIGHT  *******************************
+ * File Name          : ch32v00x_misc.h
+ * Author             : Hiranya Keshan
+ * Version            : V1.0.0
+ * Date               : 2024/10/08
+ * Description        : Host stand-in for the NVIC firmware library header.
+ *********************************************************************************/
+
+#ifndef __CH32V00x_MISC_H
+#define __CH32V00x_MISC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ch32v00x.h>
+
+typedef struct
+{
+    uint8_t NVIC_IRQChannel;
+    uint8_t NVIC_IRQChannelPreemptionPriority;
+    uint8_t NVIC_IRQChannelSubPriority;
+    FunctionalState NVIC_IRQChannelCmd;
+} NVIC_InitTypeDef;
+
+void NVIC_Init(NVIC_InitTypeDef *NVIC_InitStruct);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CH32V00x_MISC_H */
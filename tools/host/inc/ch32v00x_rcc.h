@@ -0,0 +1,30 @@
+/********************************** (C) COPYRIGHT  *******************************
+ * File Name          : ch32v00x_rcc.h
+ * Author             : Hiranya Keshan
+ * Version            : V1.0.0
+ * Date               : 2024/10/08
+ * Description        : Host stand-in for the RCC firmware library header.
+ *********************************************************************************/
+
+#ifndef __CH32V00x_RCC_H
+#define __CH32V00x_RCC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ch32v00x.h>
+
+#define RCC_APB2Periph_AFIO         ((uint32_t)0x00000001)
+#define RCC_APB2Periph_GPIOC        ((uint32_t)0x00000010)
+#define RCC_APB1Periph_TIM2         ((uint32_t)0x00000001)
+#define RCC_APB1Periph_I2C1         ((uint32_t)0x00200000)
+
+void RCC_APB2PeriphClockCmd(uint32_t RCC_APB2Periph, FunctionalState NewState);
+void RCC_APB1PeriphClockCmd(uint32_t RCC_APB1Periph, FunctionalState NewState);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CH32V00x_RCC_H */
@@ -0,0 +1,43 @@
+/********************************** (C) COPYRIGHT  *******************************
+ * File Name          : ch32v00x_tim.h
+ * Author             : Hiranya Keshan
+ * Version            : V1.0.0
+ * Date               : 2024/10/08
+ * Description        : Host stand-in for the TIM firmware library header.
+ *                      The timer never runs on the host, so backlight PWM
+ *                      edges are not modeled.
+ *********************************************************************************/
+
+#ifndef __CH32V00x_TIM_H
+#define __CH32V00x_TIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ch32v00x.h>
+
+typedef struct
+{
+    uint16_t TIM_Prescaler;
+    uint16_t TIM_CounterMode;
+    uint16_t TIM_Period;
+    uint16_t TIM_ClockDivision;
+    uint8_t TIM_RepetitionCounter;
+} TIM_TimeBaseInitTypeDef;
+
+#define TIM_CounterMode_Up          ((uint16_t)0x0000)
+#define TIM_CKD_DIV1                ((uint16_t)0x0000)
+#define TIM_IT_Update               ((uint16_t)0x0001)
+
+void TIM_TimeBaseInit(TIM_TypeDef *TIMx, TIM_TimeBaseInitTypeDef *TIM_TimeBaseInitStruct);
+void TIM_ITConfig(TIM_TypeDef *TIMx, uint16_t TIM_IT, FunctionalState NewState);
+void TIM_Cmd(TIM_TypeDef *TIMx, FunctionalState NewState);
+ITStatus TIM_GetITStatus(TIM_TypeDef *TIMx, uint16_t TIM_IT);
+void TIM_ClearITPendingBit(TIM_TypeDef *TIMx, uint16_t TIM_IT);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CH32V00x_TIM_H */
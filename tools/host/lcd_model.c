@@ -0,0 +1,324 @@
+/********************************** (C) COPYRIGHT  *******************************
+ * File Name          : lcd_model.c
+ * Author             : Hiranya Keshan
+ * Version            : V1.0.0
+ * Date               : 2024/10/08
+ * Description        : This file provides a host model of a PCF8574 backpack
+ *                      and the HD44780 controllers behind it. It decodes the
+ *                      4-bit protocol from the expander outputs, keeps DDRAM,
+ *                      CGRAM and the address counter, answers reads, and
+ *                      counts every E pulse that reaches a controller while
+ *                      it is still running the previous instruction.
+ *                      PCF8574: P0=RS, P1=R/W (E2 with two controllers),
+ *                      P2=E1, P3=backlight, P4-P7=D4-D7.
+ *                      The power-up delay is not modeled; the controllers
+ *                      start idle in 8-bit mode.
+ *********************************************************************************/
+
+#include "lcd_model.h"
+#include <string.h>
+
+modelTypeDef modelStructure;
+
+static void model_Edge(hd44780TypeDef *h, uint8_t rise, uint8_t port);
+static void model_Exec(hd44780TypeDef *h, uint8_t rs, uint8_t value);
+static void model_Step(hd44780TypeDef *h, uint8_t up);
+
+/*********************************************************************
+ * @fn      model_Begin
+ *
+ * @brief   Powers the model up: time zero, controllers in 8-bit mode with
+ *          DDRAM holding a pattern that only a clear removes.
+ *
+ * @param   controllers - 1, or 2 for a 40x4 panel with E2 on P1.
+ *
+ * @return  None.
+ */
+void model_Begin(uint8_t controllers)
+{
+    memset(&modelStructure, 0, sizeof(modelStructure));
+    modelStructure.controllers = (controllers == 2) ? 2 : 1;
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        hd44780TypeDef *h = &modelStructure.lcd[i];
+
+        memset(h->ddram, 0xA5, sizeof(h->ddram));
+        memset(h->cgram, 0x15, sizeof(h->cgram));
+        h->incr = 1;
+        h->bits8 = 1;
+    }
+}
+
+/*********************************************************************
+ * @fn      model_Wait
+ *
+ * @brief   Lets time pass with the bus idle.
+ *
+ * @param   ns - Time in nanoseconds.
+ *
+ * @return  None.
+ */
+void model_Wait(uint64_t ns)
+{
+    modelStructure.now_ns += ns;
+}
+
+/*********************************************************************
+ * @fn      model_Clock
+ *
+ * @brief   Lets time pass with the bus clocking.
+ *
+ * @param   bits  - SCL periods.
+ *          bound - Bus clock in Hz.
+ *
+ * @return  None.
+ */
+void model_Clock(uint32_t bits, uint32_t bound)
+{
+    uint64_t ns = (uint64_t)bits * 1000000000 / bound;
+
+    modelStructure.now_ns += ns;
+    modelStructure.bus_ns += ns;
+}
+
+/*********************************************************************
+ * @fn      model_Port
+ *
+ * @brief   Sets the PCF8574 outputs and passes E edges on to the
+ *          controllers.
+ *
+ * @param   port - Expander output byte.
+ *
+ * @return  None.
+ */
+void model_Port(uint8_t port)
+{
+    uint8_t old = modelStructure.port;
+    static const uint8_t e_bit[2] = { 0x04, 0x02 };
+
+    modelStructure.port = port;
+
+    for (uint8_t i = 0; i < modelStructure.controllers; i++)
+    {
+        uint8_t was = old & e_bit[i];
+        uint8_t is = port & e_bit[i];
+
+        if (was != is)
+        {
+            model_Edge(&modelStructure.lcd[i], is ? 1 : 0, port);
+        }
+    }
+}
+
+/*********************************************************************
+ * @fn      model_Pins
+ *
+ * @brief   Reads the PCF8574 inputs. Outputs written high are weak pull-ups,
+ *          so D4-D7 follow a controller that is driving them for a read.
+ *
+ * @param   None.
+ *
+ * @return  Expander input byte.
+ */
+uint8_t model_Pins(void)
+{
+    uint8_t pins = modelStructure.port;
+    hd44780TypeDef *h = &modelStructure.lcd[0];
+
+    if (modelStructure.controllers == 1 && (pins & 0x06) == 0x06)
+    {
+        uint8_t nibble = h->nibble ? (h->out & 0x0F) : (h->out >> 4);
+
+        pins &= 0x0F | (nibble << 4);
+    }
+    return pins;
+}
+
+/*********************************************************************
+ * @fn      model_Edge
+ *
+ * @brief   One edge on a controller's E line. A rising edge checks the busy
+ *          time and, for a read, puts the byte on the bus. The falling edge
+ *          latches a written nibble, or ends a read.
+ *
+ * @param   h    - Controller.
+ *          rise - 1 for a rising edge.
+ *          port - Expander outputs after the edge.
+ *
+ * @return  None.
+ */
+static void model_Edge(hd44780TypeDef *h, uint8_t rise, uint8_t port)
+{
+    uint8_t rs = port & 0x01;
+    uint8_t rw = (modelStructure.controllers == 1) ? (port >> 1) & 0x01 : 0;
+
+    if (rise)
+    {
+        modelStructure.strobes++;
+        if (modelStructure.now_ns < h->busy_ns)
+        {
+            modelStructure.violations++;
+        }
+
+        if (rw && !h->nibble)
+        {
+            if (rs)
+            {
+                h->out = h->cg ? h->cgram[h->ac & 0x3F] : h->ddram[h->ac & 0x7F];
+            }
+            else
+            {
+                h->out = ((modelStructure.now_ns < h->busy_ns) ? 0x80 : 0x00) | h->ac;
+            }
+        }
+        return;
+    }
+
+    if (rw)
+    {
+        if (h->nibble && rs)
+        {
+            model_Step(h, h->incr);
+            h->busy_ns = modelStructure.now_ns + MODEL_EXEC_NS;
+        }
+        h->nibble ^= 1;
+        return;
+    }
+
+    if (h->bits8)
+    {
+        /* D0-D3 are not wired, they read as 0 */
+        model_Exec(h, rs, port & 0xF0);
+    }
+    else if (!h->nibble)
+    {
+        h->high = port & 0xF0;
+        h->nibble = 1;
+    }
+    else
+    {
+        h->nibble = 0;
+        model_Exec(h, rs, h->high | (port >> 4));
+    }
+}
+
+/*********************************************************************
+ * @fn      model_Exec
+ *
+ * @brief   Runs one data write or instruction.
+ *
+ * @param   h     - Controller.
+ *          rs    - 1 for data.
+ *          value - Byte written.
+ *
+ * @return  None.
+ */
+static void model_Exec(hd44780TypeDef *h, uint8_t rs, uint8_t value)
+{
+    uint32_t ns = MODEL_EXEC_NS;
+
+    if (rs)
+    {
+        if (h->cg)
+        {
+            h->cgram[h->ac & 0x3F] = value;
+        }
+        else
+        {
+            h->ddram[h->ac & 0x7F] = value;
+        }
+        model_Step(h, h->incr);
+    }
+    else if (value & 0x80)
+    {
+        h->ac = value & 0x7F;
+        h->cg = 0;
+    }
+    else if (value & 0x40)
+    {
+        h->ac = value & 0x3F;
+        h->cg = 1;
+    }
+    else if (value & 0x20)
+    {
+        h->bits8 = (value & 0x10) ? 1 : 0;
+        h->lines2 = (value & 0x08) ? 1 : 0;
+        h->nibble = 0;
+    }
+    else if (value & 0x10)
+    {
+        /* Cursor move steps the AC, display shift leaves it */
+        if (!(value & 0x08))
+        {
+            model_Step(h, (value & 0x04) ? 1 : 0);
+        }
+    }
+    else if (value & 0x08)
+    {
+        h->control = value & 0x07;
+    }
+    else if (value & 0x04)
+    {
+        h->incr = (value & 0x02) ? 1 : 0;
+        h->shift = value & 0x01;
+    }
+    else if (value & 0x02)
+    {
+        h->ac = 0;
+        h->cg = 0;
+        ns = MODEL_HOME_NS;
+    }
+    else if (value & 0x01)
+    {
+        memset(h->ddram, ' ', sizeof(h->ddram));
+        h->ac = 0;
+        h->cg = 0;
+        h->incr = 1;
+        ns = MODEL_HOME_NS;
+    }
+
+    h->busy_ns = modelStructure.now_ns + ns;
+}
+
+/*********************************************************************
+ * @fn      model_Step
+ *
+ * @brief   Moves the address counter by one, wrapping as the controller
+ *          does: CGRAM in 64 bytes, two-line DDRAM from 0x27 to 0x40 and
+ *          from 0x67 to 0x00, one-line DDRAM in 0x00-0x4F.
+ *
+ * @param   h  - Controller.
+ *          up - 1 to increment, 0 to decrement.
+ *
+ * @return  None.
+ */
+static void model_Step(hd44780TypeDef *h, uint8_t up)
+{
+    if (h->cg)
+    {
+        h->ac = (h->ac + (up ? 1 : -1)) & 0x3F;
+    }
+    else if (h->lines2)
+    {
+        if (up)
+        {
+            h->ac = (h->ac == 0x27) ? 0x40 : (h->ac == 0x67) ? 0x00 : h->ac + 1;
+        }
+        else
+        {
+            h->ac = (h->ac == 0x40) ? 0x27 : (h->ac == 0x00) ? 0x67 : h->ac - 1;
+        }
+    }
+    else
+    {
+        if (up)
+        {
+            h->ac = (h->ac >= 0x4F) ? 0x00 : h->ac + 1;
+        }
+        else
+        {
+            h->ac = (h->ac == 0x00) ? 0x4F : h->ac - 1;
+        }
+    }
+}
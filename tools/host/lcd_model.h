@@ -0,0 +1,68 @@
+/********************************** (C) COPYRIGHT  *******************************
+ * File Name          : lcd_model.h
+ * Author             : Hiranya Keshan
+ * Version            : V1.0.0
+ * Date               : 2024/10/08
+ * Description        : This file contains all the function prototypes for the
+ *                      host model of a PCF8574 backpack driving one or two
+ *                      HD44780 controllers.
+ *********************************************************************************/
+
+#ifndef LCD_MODEL_H_
+#define LCD_MODEL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Execution times from the HD44780 datasheet, in nanoseconds. */
+#define MODEL_EXEC_NS               37000
+#define MODEL_HOME_NS               1520000
+
+typedef struct
+{
+    uint8_t ddram[128];
+    uint8_t cgram[64];
+    uint8_t ac;             /* Address counter */
+    uint8_t cg;             /* AC points into CGRAM */
+    uint8_t incr;           /* Entry mode I/D */
+    uint8_t shift;          /* Entry mode S */
+    uint8_t control;        /* Display control D, C, B */
+    uint8_t bits8;          /* Function set DL */
+    uint8_t lines2;         /* Function set N */
+    uint8_t nibble;         /* Next transfer is the low nibble */
+    uint8_t high;           /* High nibble written */
+    uint8_t out;            /* Byte being read */
+    uint64_t busy_ns;       /* Running an instruction until then */
+
+} hd44780TypeDef;
+
+typedef struct
+{
+    hd44780TypeDef lcd[2];
+    uint8_t controllers;    /* 2: P1 drives E2 and R/W is tied low */
+    uint8_t port;           /* PCF8574 output latch */
+
+    uint64_t now_ns;        /* Model time */
+    uint64_t bus_ns;        /* Time the I2C bus was clocking */
+    uint32_t strobes;       /* E pulses seen */
+    uint32_t violations;    /* E pulses while the controller was busy */
+    uint32_t bus_errors;    /* Transfers the PCF8574 did not acknowledge */
+
+} modelTypeDef;
+
+extern modelTypeDef modelStructure;
+
+void model_Begin(uint8_t controllers);
+void model_Wait(uint64_t ns);
+void model_Clock(uint32_t bits, uint32_t bound);
+void model_Port(uint8_t port);
+uint8_t model_Pins(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LCD_MODEL_H_ */
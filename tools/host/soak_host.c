@@ -0,0 +1,100 @@
+/********************************** (C) COPYRIGHT  *******************************
+ * File Name          : soak_host.c
+ * Author             : Hiranya Keshan
+ * Version            : V1.0.0
+ * Date               : 2024/10/08
+ * Description        : Runs the soak test (LCD_Soak.c) on the host, with the
+ *                      I2C LCD library driving the PCF8574/HD44780 model.
+ *                      ops/s is timed with the model's clock, i.e. the time
+ *                      the panel and bus take, which is the same on every
+ *                      run with the same seed. The process CPU time is
+ *                      reported beside it; its slowdown is taken from the
+ *                      fastest window of each segment, which other load on
+ *                      the machine can only slow down, not speed up.
+ *
+ *                      Usage: lcd_soak [ops] [seed] [max slowdown %]
+ *                                      [max CPU slowdown %]
+ *
+ *                      Exits with 1 on readback errors, E pulses while busy,
+ *                      bus errors, or a slowdown above either limit.
+ *********************************************************************************/
+
+#include <I2C_LCD.h>
+#include <LCD_Soak.h>
+#include "lcd_model.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*********************************************************************
+ * @fn      soak_Clock
+ *
+ * @brief   Microseconds of model time.
+ *
+ * @param   None.
+ *
+ * @return  Free-running microsecond count.
+ */
+uint32_t soak_Clock(void)
+{
+    return (uint32_t)(modelStructure.now_ns / 1000);
+}
+
+/*********************************************************************
+ * @fn      soak_CpuClock
+ *
+ * @brief   Microseconds of CPU time used by the process (SOAK_CPU_CLOCK).
+ *
+ * @param   None.
+ *
+ * @return  Free-running microsecond count.
+ */
+uint32_t soak_CpuClock(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t ops = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1000000;
+    uint32_t seed = (argc > 2) ? strtoul(argv[2], NULL, 0) : 1;
+    uint32_t limit = (argc > 3) ? strtoul(argv[3], NULL, 0) : 10;
+    uint32_t cpu_limit = (argc > 4) ? strtoul(argv[4], NULL, 0) : limit;
+    soakTypeDef soak;
+
+    model_Begin(1);
+    i2c_Begin(400000 , TxAdderss);
+    lcd_Begin(2 , 16);
+
+    soak_Run(&soak, ops, seed, 4, 20);
+
+    printf("soak %lu ops, %lu sessions, %lu checks, %lu errors\n",
+           (unsigned long)soak.ops, (unsigned long)soak.sessions,
+           (unsigned long)soak.checks, (unsigned long)soak.errors);
+    printf("ops/s early %lu, late %lu, min %lu, avg %lu, slowdown %u%%, bus %u%%\n",
+           (unsigned long)soak.early_ops_s, (unsigned long)soak.late_ops_s,
+           (unsigned long)soak.min_ops_s, (unsigned long)soak.avg_ops_s,
+           soak.slowdown, soak.bus_load);
+    printf("energy %lu nJ/op, asleep %u%%\n", (unsigned long)soak.energy_nj, soak.sleep_load);
+    printf("cpu %lu ms, ops/s avg %lu, best early %lu, best late %lu, slowdown %u%%\n",
+           (unsigned long)soak.cpu_ms, (unsigned long)soak.cpu_avg_ops_s,
+           (unsigned long)soak.cpu_early_ops_s, (unsigned long)soak.cpu_late_ops_s,
+           soak.cpu_slowdown);
+    printf("model %.1f s, bus %.1f%%, %lu E pulses, %lu while busy, %lu bus errors\n",
+           modelStructure.now_ns / 1e9,
+           modelStructure.now_ns ? 100.0 * modelStructure.bus_ns / modelStructure.now_ns : 0.0,
+           (unsigned long)modelStructure.strobes, (unsigned long)modelStructure.violations,
+           (unsigned long)modelStructure.bus_errors);
+
+    if (soak.errors || modelStructure.violations || modelStructure.bus_errors
+        || soak.slowdown > limit || soak.cpu_slowdown > cpu_limit)
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
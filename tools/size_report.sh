@@ -0,0 +1,65 @@
+#!/bin/sh
+#
+# Flash and RAM cost of each I2C_LCD feature (see I2C_LCD_conf.h).
+#
+# Usage: tools/size_report.sh <EVT SRC dir> [User dir]
+#
+#   EVT SRC dir - CH32V003EVT/EVT/EXAM/SRC, holding Core, Debug and Peripheral
+#   User dir    - directory with ch32v00x_conf.h (default: any EVT example)
+#
+# Set CROSS to the toolchain prefix if it is not riscv-none-embed-.
+# Sizes are of the driver object alone, built as MounRiver does (-Os).
+
+set -e
+
+SRC=${1:?usage: $0 <EVT SRC dir> [User dir]}
+USER_DIR=${2:-$(dirname "$(find "$SRC/.." -name ch32v00x_conf.h | head -n 1)")}
+CROSS=${CROSS:-riscv-none-embed-}
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+CFLAGS="-march=rv32ec -mabi=ilp32e -msmall-data-limit=0 -msave-restore -Os \
+ -fmessage-length=0 -fsigned-char -w -ffunction-sections -fdata-sections \
+ -I$SRC/Core -I$SRC/Debug -I$SRC/Peripheral/inc -I$USER_DIR -I$ROOT"
+
+NONE="-DLCD_USE_CURSOR=0 -DLCD_USE_SHIFT=0 -DLCD_USE_CGRAM=0 -DLCD_USE_BACKLIGHT=0 \
+ -DLCD_USE_READ=0 -DLCD_USE_PWM=0 -DLCD_USE_SHADOW=0 -DLCD_USE_STATS=0 -DLCD_CONTROLLERS=1"
+
+# size <defines> -> "flash ram"
+size() {
+    ${CROSS}gcc $CFLAGS $1 -c "$ROOT/I2C_LCD.c" -o "$TMP/lcd.o"
+    ${CROSS}size "$TMP/lcd.o" | awk 'NR == 2 { print $1 + $2, $2 + $3 }'
+}
+
+set -- $(size "$NONE")
+BASE_FLASH=$1
+BASE_RAM=$2
+
+printf '%-24s %8s %8s\n' "feature" "flash" "ram"
+printf '%-24s %8d %8d\n' "core (all off)" "$BASE_FLASH" "$BASE_RAM"
+
+# Each entry is "<feature> [prerequisites...]". The cost is measured
+# against a build that already has the prerequisites.
+for f in LCD_USE_CURSOR LCD_USE_SHIFT LCD_USE_CGRAM LCD_USE_BACKLIGHT \
+         "LCD_USE_PWM LCD_USE_BACKLIGHT" LCD_USE_READ LCD_USE_SHADOW LCD_USE_STATS \
+         "LCD_CONTROLLERS=2" "LCD_LOWPOWER"; do
+    defs="$NONE"
+    pre=""
+    for d in $f; do
+        case $d in
+            *=*) d="-D$d" ;;
+            *)   d="-D$d=1" ;;
+        esac
+        defs="$defs $d"
+        [ "$d" = "-D${f%% *}=1" ] || [ "$d" = "-D${f%% *}" ] || pre="$pre $d"
+    done
+    set -- $(size "$NONE$pre")
+    PRE_FLASH=$1
+    PRE_RAM=$2
+    set -- $(size "$defs")
+    printf '%-24s %+8d %+8d\n' "${f%% *}" $(($1 - PRE_FLASH)) $(($2 - PRE_RAM))
+done
+
+set -- $(size "")
+printf '%-24s %8d %8d\n' "default config" "$1" "$2"